@@ -0,0 +1,41 @@
+#include <cstdio>
+#include <string>
+#include "bench.h"
+#include "../src/arena.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+#include "../src/source.h"
+#include "../src/token_stream.h"
+
+// cost of building (and dropping) the AST for a large program
+
+void bench_ast() {
+  const int lines = 100000;
+  std::string text;
+
+  for(int i = 0; i < lines; i++) {
+    text += std::string("var x = x + ") + std::to_string(i % 97) + " * 2 - (x % 7) / 3\n";
+  }
+
+  auto source = SourceManager::instance().add("<bench>", text);
+  std::size_t allocs = 0, nodes = 0, bytes = 0;
+
+  double seconds = best_of(3, [&]() {
+    std::size_t before = allocation_count();
+
+    AstArena arena;
+    Lexer lexer(source);
+    TokenStream tokens(lexer);
+    Parser parser(tokens, arena);
+    if(!parser.parse()) std::printf("  parse error\n");
+
+    allocs = allocation_count() - before;
+    nodes = arena.get_node_count();
+    bytes = arena.get_bytes_used();
+  });
+
+  report(std::string("parse ") + std::to_string(lines) + " statements", seconds, lines, "stmts");
+  std::printf("  %-40s %10zu\n", "heap allocations", allocs);
+  std::printf("  %-40s %10zu\n", "arena nodes", nodes);
+  std::printf("  %-40s %10zu KiB\n", "arena bytes", bytes >> 10);
+}
@@ -0,0 +1,54 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "../src/batch/batch.h"
+#include "../src/program.h"
+
+// expressions over a million rows, one row at a time through the compiled
+// program against whole blocks of rows through the batch kernels
+
+static const char* EXPRESSIONS[][2] = {
+  { "arithmetic", "(x * 2 + y) / (y + 1) - x ^ 2" },
+  { "comparisons, and/or", "x > 100 and y < 50 or not x == y" },
+  { "if/elif/else", "if x > 100 then x * y - 20 elif x > 10 then x * y else 0" },
+};
+
+void bench_batch() {
+  const std::size_t ROWS = 1000000;
+  std::vector<double> xs(ROWS), ys(ROWS), out(ROWS);
+
+  for(std::size_t i = 0; i < ROWS; i++) {
+    xs[i] = (double)((i * 7919) % 1000) / 3;
+    ys[i] = (double)((i * 104729) % 100);
+  }
+
+  for(const auto& [name, text] : EXPRESSIONS) {
+    auto [program, error] = compile("<bench>", text);
+    if(!program) continue;
+
+    std::uint32_t x = *program->slot_of("x"), y = *program->slot_of("y");
+
+    double seconds = best_of(3, [&]() {
+      Bindings bindings = program->bind();
+
+      for(std::size_t i = 0; i < ROWS; i++) {
+        bindings.set(x, xs[i]);
+        bindings.set(y, ys[i]);
+        RunType result = program->evaluate(bindings);
+        out[i] = result.first ? std::get<Number>(*result.first).get_value() : 0;
+      }
+    });
+    report(std::string(name) + ", row by row", seconds, ROWS, "rows");
+
+    auto [batch, batch_error] = BatchProgram::compile(program);
+    if(!batch) continue;
+
+    Columns columns(*program);
+    columns.set(x, xs);
+    columns.set(y, ys);
+
+    seconds = best_of(3, [&]() { (void)batch->evaluate(columns, out); });
+    report(std::string(name) + ", batch", seconds, ROWS, "rows");
+  }
+}
@@ -0,0 +1,71 @@
+#ifndef BENCH
+#define BENCH
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// tiny timing helpers shared by the benchmark suites
+
+using BenchClock = std::chrono::steady_clock;
+
+// runs fn once and returns the wall time in seconds
+template<typename F>
+double time_it(F&& fn) {
+  auto start = BenchClock::now();
+  fn();
+  return std::chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+// best of `reps` runs, to keep scheduler noise out of the numbers
+template<typename F>
+double best_of(int reps, F&& fn) {
+  double best = 1e300;
+  for(int i = 0; i < reps; i++) {
+    double t = time_it(fn);
+    if(t < best) best = t;
+  }
+  return best;
+}
+
+// stops the benchmark when what it measures went wrong, a script failing
+// fast is not a result
+inline void require(bool ok, const std::string& what) {
+  if(ok) return;
+
+  std::fprintf(stderr, "benchmark failed: %s\n", what.c_str());
+  std::exit(1);
+}
+
+inline void report(const std::string& name, double seconds, double units, const char* unit) {
+  std::printf("  %-40s %10.3f ms  %12.0f %s/s\n", name.c_str(), seconds * 1e3, units / seconds, unit);
+}
+
+enum Backend : std::uint8_t;
+
+// "tree", "vm" or "closure" (bench/vm.cpp)
+const char* backend_name(Backend backend);
+
+// number of global operator new calls so far (bench/alloc.cpp)
+std::size_t allocation_count();
+
+// suites
+void bench_script();
+void bench_ast();
+void bench_parse();
+void bench_vm();
+void bench_result();
+void bench_loop();
+void bench_quicken();
+void bench_fold();
+void bench_engine();
+void bench_program();
+void bench_batch();
+void bench_filter();
+void bench_csv();
+void bench_runner();
+
+#endif
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench.h"
+#include "../src/csv.h"
+#include "../src/driver.h"
+#include "../src/source.h"
+
+// a formula over every record of a csv export: a run() per record, as
+// through the repl, against run_csv parsing and evaluating in chunks
+
+static const char* FORMULA =
+  "if x > 100 then x * rate - fee elif x > 10 then x * rate else 0";
+
+void bench_csv() {
+  const std::size_t RECORDS = 1000000, SLOW_RECORDS = 20000;
+
+  std::string text = "id,x,rate,fee,note\n";
+
+  for(std::size_t i = 0; i < RECORDS; i++) {
+    text += std::to_string(i) + "," + std::to_string((double)((i * 7919) % 1000) / 3) + ",1.5,20,7\n";
+  }
+
+  auto data = SourceManager::instance().add("<bench>.csv", text);
+  auto script = SourceManager::instance().add("<bench>", FORMULA);
+
+  double seconds = best_of(3, [&]() {
+    CsvReader reader(data);
+    CsvChunk chunk = reader.next_chunk(SLOW_RECORDS);
+    std::size_t line_begin = chunk.begin;
+
+    for(std::size_t i = 0; i < SLOW_RECORDS; i++) {
+      std::size_t line_end = text.find('\n', line_begin);
+      std::string line = text.substr(line_begin, line_end - line_begin);
+      line_begin = line_end + 1;
+
+      // id,x,rate,fee,note
+      std::size_t a = line.find(','), b = line.find(',', a + 1);
+      (void)run("<stdin>", std::string("var x = ") + line.substr(a + 1, b - a - 1) + "; var rate = 1.5; var fee = 20; " + FORMULA);
+    }
+  });
+  report("run() per record", seconds, SLOW_RECORDS, "records");
+
+  seconds = best_of(3, [&]() {
+    CsvReader reader(data);
+    std::vector<std::vector<double>> fields(5);
+    std::vector<std::vector<double>*> columns = { nullptr, &fields[1], &fields[2], &fields[3], nullptr };
+    std::size_t records;
+
+    for(CsvChunk chunk = reader.next_chunk(CSV_CHUNK_ROWS); !chunk.empty(); chunk = reader.next_chunk(CSV_CHUNK_ROWS)) {
+      for(auto& field : fields) field.clear();
+      (void)reader.parse(chunk, columns, records);
+    }
+  });
+  report("parse x, rate, fee", seconds, RECORDS, "records");
+
+  unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+  for(unsigned threads : { 1u, 2u, 4u, 8u }) {
+    if(threads > 2 * cores) break;
+
+    seconds = best_of(3, [&]() {
+      std::FILE* sink = std::tmpfile();
+      if(!sink) return;
+
+      {
+        OutputBuffer out(sink);
+        (void)run_csv(data, script, out, {}, threads);
+      }
+
+      std::fclose(sink);
+    });
+    report(std::string("run_csv, ") + std::to_string(threads) + " threads", seconds, RECORDS, "records");
+  }
+}
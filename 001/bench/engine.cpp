@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench.h"
+#include "../src/engine.h"
+#include "../src/source.h"
+
+// many short scripts, where the fixed cost of a run matters, first on one
+// engine and then spread over threads that own an engine each
+
+static const int RUNS = 20000;
+
+static const char* SCRIPT = "var x = 3\nvar y = x * 2 + 1\nif y > 5 then y - x else x";
+
+// every thread runs RUNS scripts, the total throughput is reported
+static double run_threads(unsigned threads, Backend backend) {
+  auto source = SourceManager::instance().add("<bench>", SCRIPT);
+
+  return best_of(3, [&]() {
+    std::vector<std::thread> workers;
+
+    for(unsigned t = 0; t < threads; t++) {
+      workers.emplace_back([&]() {
+        Engine engine;
+        RunOptions options;
+        options.backend = backend;
+
+        for(int i = 0; i < RUNS; i++) (void)engine.run(source, options);
+      });
+    }
+
+    for(std::thread& worker : workers) worker.join();
+  });
+}
+
+void bench_engine() {
+  auto source = SourceManager::instance().add("<bench>", SCRIPT);
+
+  double seconds = best_of(3, [&]() {
+    for(int i = 0; i < RUNS; i++) (void)run(source);
+  });
+  report("run()", seconds, RUNS, "runs");
+
+  for(Backend backend : { BACKEND_TREE, BACKEND_VM, BACKEND_CLOSURE }) {
+    Engine engine;
+    RunOptions options;
+    options.backend = backend;
+
+    seconds = best_of(3, [&]() {
+      for(int i = 0; i < RUNS; i++) (void)engine.run(source, options);
+    });
+    report(std::string("Engine::run, ") + backend_name(backend), seconds, RUNS, "runs");
+  }
+
+  // past the core count the numbers only show scheduling overhead
+  unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+  for(unsigned threads : { 1u, 2u, 4u, 8u, 16u }) {
+    if(threads > 2 * cores) break;
+
+    seconds = run_threads(threads, BACKEND_TREE);
+    report(std::to_string(threads) + " threads, engine each", seconds, (double)RUNS * threads, "runs");
+  }
+}
@@ -0,0 +1,72 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "../src/batch/batch.h"
+#include "../src/program.h"
+
+// which of a million rows pass a predicate: the compiled program row by
+// row, the batch kernels computing values, and a filter computing masks
+
+static const char* PREDICATES[][2] = {
+  { "negation", "x > 3 and not y == 0" },
+  { "range", "x >= 100 and x < 200 or y > 90" },
+  { "arithmetic operands", "(x * 2 > y or y == 7) and not x - y < 10" },
+};
+
+void bench_filter() {
+  const std::size_t ROWS = 1000000;
+  std::vector<double> xs(ROWS), ys(ROWS);
+  std::vector<std::uint32_t> selected;
+  std::vector<std::uint64_t> bitmap((ROWS + 63) / 64);
+
+  selected.reserve(ROWS);
+
+  for(std::size_t i = 0; i < ROWS; i++) {
+    xs[i] = (double)((i * 7919) % 1000) / 3;
+    ys[i] = (double)((i * 104729) % 100);
+  }
+
+  for(const auto& [name, text] : PREDICATES) {
+    auto [program, error] = compile("<bench>", text);
+    if(!program) continue;
+
+    std::uint32_t x = *program->slot_of("x"), y = *program->slot_of("y");
+
+    double seconds = best_of(3, [&]() {
+      Bindings bindings = program->bind();
+      selected.clear();
+
+      for(std::size_t i = 0; i < ROWS; i++) {
+        bindings.set(x, xs[i]);
+        bindings.set(y, ys[i]);
+        RunType result = program->evaluate(bindings);
+        if(result.first && std::get<Number>(*result.first).is_true()) selected.push_back(i);
+      }
+    });
+    report(std::string(name) + ", row by row", seconds, ROWS, "rows");
+
+    auto [batch, batch_error] = BatchProgram::compile(program);
+    auto [filter, filter_error] = BatchProgram::compile_filter(program);
+    if(!batch || !filter) continue;
+
+    Columns columns(*program);
+    columns.set(x, xs);
+    columns.set(y, ys);
+
+    seconds = best_of(3, [&]() {
+      selected.clear();
+      (void)batch->select(columns, ROWS, selected);
+    });
+    report(std::string(name) + ", values, selection", seconds, ROWS, "rows");
+
+    seconds = best_of(3, [&]() {
+      selected.clear();
+      (void)filter->select(columns, ROWS, selected);
+    });
+    report(std::string(name) + ", masks, selection", seconds, ROWS, "rows");
+
+    seconds = best_of(3, [&]() { (void)filter->filter(columns, ROWS, bitmap); });
+    report(std::string(name) + ", masks, bitmap", seconds, ROWS, "rows");
+  }
+}
@@ -0,0 +1,58 @@
+#include <cstdio>
+#include <memory>
+#include <string>
+#include "bench.h"
+#include "../src/arena.h"
+#include "../src/context.h"
+#include "../src/folder.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+#include "../src/resolver.h"
+#include "../src/source.h"
+#include "../src/token_stream.h"
+#include "../src/state/interpreter.h"
+#include "../src/state/symbol_table.h"
+
+// tree walker evaluation with and without constant folding, on loops whose
+// bodies recompute constants every iteration
+
+static const char* SCRIPTS[][2] = {
+  { "constant factor", "var s = 0\nfor i = 0 to 1000000 do var s = s + 2^10 * 3 + i * 1" },
+  { "constant if", "var s = 0\nfor i = 0 to 1000000 do var s = s + (if 1 then 60 * 60 else 0) / (24 - 0)" },
+  { "nothing to fold", "var s = 0\nfor i = 0 to 1000000 do var s = s + i * 3 - s / 7" },
+};
+
+void bench_fold() {
+  for(const auto& [name, text] : SCRIPTS) {
+    auto source = SourceManager::instance().add("<bench>", text);
+
+    for(bool folding : { false, true }) {
+      AstArena arena;
+      Lexer lexer(source);
+      TokenStream tokens(lexer);
+      Parser parser(tokens, arena);
+      auto ast = parser.parse();
+      if(!ast) return;
+
+      FoldStats stats;
+      if(folding) stats = ConstantFolder::fold(ast.value(), arena);
+
+      auto table = std::make_shared<SymbolTable>();
+      Resolver::resolve(ast.value(), *table);
+
+      Context context("<bench>");
+      context.symbol_table = table;
+      Interpreter interpreter;
+
+      double seconds = best_of(3, [&]() { (void)interpreter.visit(ast.value(), context); });
+      report(std::string(name) + (folding ? ", folded" : ", as parsed"), seconds, 1e6, "iters");
+
+      if(folding) {
+        std::printf(
+          "    %zu folded, %zu simplified, %zu nodes eliminated\n",
+          stats.folded, stats.simplified, stats.eliminated
+        );
+      }
+    }
+  }
+}
@@ -0,0 +1,29 @@
+#include <cstdio>
+#include <string>
+#include "bench.h"
+#include "../src/lexer.h"
+#include "../src/source.h"
+
+// counted for loops of 10^7 iterations, with a body that does not look at
+// the loop variable and with one that does
+
+static const char* LOOPS[][2] = {
+  { "empty body", "for i = 0 to 10000000 do 0" },
+  { "body without i", "var s = 0\nfor i = 0 to 10000000 do var s = s + 1\ns" },
+  { "body reads i", "var s = 0\nfor i = 0 to 10000000 do var s = s + i\ns" },
+  { "step -2", "var s = 0\nfor i = 20000000 to 0 step -2 do var s = s + 1\ns" },
+};
+
+void bench_loop() {
+  for(const auto& [name, text] : LOOPS) {
+    auto source = SourceManager::instance().add("<bench>", text);
+
+    for(Backend backend : { BACKEND_TREE, BACKEND_VM, BACKEND_CLOSURE }) {
+      RunOptions options;
+      options.backend = backend;
+
+      double seconds = best_of(3, [&]() { (void)run(source, options); });
+      report(std::string(name) + ", " + backend_name(backend), seconds, 1e7, "iters");
+    }
+  }
+}
@@ -0,0 +1,43 @@
+#include <cstdio>
+#include <cstring>
+#include "bench.h"
+
+// basicpl_bench            run every suite
+// basicpl_bench <suite>... run only the named suites
+
+struct Suite {
+  const char* name;
+  void (*run)();
+};
+
+static const Suite SUITES[] = {
+  { "script", bench_script },
+  { "ast", bench_ast },
+  { "parse", bench_parse },
+  { "vm", bench_vm },
+  { "result", bench_result },
+  { "loop", bench_loop },
+  { "quicken", bench_quicken },
+  { "fold", bench_fold },
+  { "engine", bench_engine },
+  { "program", bench_program },
+  { "batch", bench_batch },
+  { "filter", bench_filter },
+  { "csv", bench_csv },
+  { "runner", bench_runner },
+};
+
+int main(int argc, char** argv) {
+  for(const Suite& suite : SUITES) {
+    bool selected = argc == 1;
+
+    for(int i = 1; i < argc; i++) {
+      if(std::strcmp(argv[i], suite.name) == 0) selected = true;
+    }
+
+    if(!selected) continue;
+
+    std::printf("%s\n", suite.name);
+    suite.run();
+  }
+}
@@ -0,0 +1,51 @@
+#include <cstdio>
+#include <string>
+#include "bench.h"
+#include "../src/arena.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+#include "../src/source.h"
+#include "../src/token_stream.h"
+
+// expression parsing on deeply nested and long flat arithmetic
+
+static double parse_seconds(const std::string& text, int reps) {
+  auto source = SourceManager::instance().add("<bench>", text);
+
+  return best_of(reps, [&]() {
+    AstArena arena;
+    Lexer lexer(source);
+    TokenStream tokens(lexer);
+    Parser parser(tokens, arena);
+    Result<ASTNode*> res = parser.parse();
+    if(!res) std::printf("  parse error: %s\n", res.get_error()->as_string().c_str());
+  });
+}
+
+void bench_parse() {
+  // ((((1 + 2) * 3 - 4) / 5) ^ 1 ...) nested 400 deep, 200 statements
+  std::string nested;
+  for(int s = 0; s < 200; s++) {
+    std::string expr = "1";
+    for(int i = 0; i < 400; i++) {
+      const char* ops[] = { " + ", " * ", " - ", " / ", " % " };
+      expr = std::string("(") + expr + ops[i % 5] + std::to_string(i % 9 + 1) + ")";
+    }
+    nested += expr + "\n";
+  }
+
+  // a + b * c - d / e < f and ... one long flat statement per line
+  std::string flat;
+  for(int s = 0; s < 2000; s++) {
+    for(int i = 0; i < 50; i++) {
+      flat += std::to_string(i) + " + " + std::to_string(i) + " * 2 - 3 / 4 ^ 2 < 9 and ";
+    }
+    flat += "1\n";
+  }
+
+  double seconds = parse_seconds(nested, 5);
+  report("nested 200 x 400 parens", seconds, 200 * 400, "ops");
+
+  seconds = parse_seconds(flat, 5);
+  report("flat 2000 x 350 operators", seconds, 2000 * 350, "ops");
+}
@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench.h"
+#include "../src/engine.h"
+#include "../src/program.h"
+#include "../src/source.h"
+
+// one formula over many input rows: rerunning the script for every row
+// against compiling it once and evaluating it with new bindings
+
+static const char* FORMULA =
+  "if x > 100 then x * rate - fee elif x > 10 then x * rate else 0";
+
+static std::vector<double> make_rows(std::size_t count) {
+  std::vector<double> rows(count);
+  for(std::size_t i = 0; i < count; i++) rows[i] = (double)((i * 7919) % 1000) / 3;
+  return rows;
+}
+
+// evaluates rows with one Bindings, returns the sum so nothing is skipped
+static double evaluate_rows(const Program& program, const double* rows, std::size_t count) {
+  Bindings bindings = program.bind();
+  std::uint32_t x = *program.slot_of("x");
+  bindings.set(*program.slot_of("rate"), 1.5);
+  bindings.set(*program.slot_of("fee"), 20);
+
+  double sum = 0;
+
+  for(std::size_t i = 0; i < count; i++) {
+    bindings.set(x, rows[i]);
+    RunType result = program.evaluate(bindings);
+    if(result.first) sum += std::get<Number>(*result.first).get_value();
+  }
+
+  return sum;
+}
+
+void bench_program() {
+  const std::size_t SLOW_ROWS = 100000, ROWS = 1000000;
+  std::vector<double> rows = make_rows(ROWS);
+
+  double seconds = best_of(3, [&]() {
+    for(std::size_t i = 0; i < SLOW_ROWS; i++) {
+      (void)run("<bench>", std::string("var x = ") + std::to_string(rows[i]) + "\nvar rate = 1.5\nvar fee = 20\n" + FORMULA);
+    }
+  });
+  report("run() per row", seconds, SLOW_ROWS, "rows");
+
+  {
+    Engine engine;
+    auto source = SourceManager::instance().add("<bench>", FORMULA);
+    engine.get_globals().set("rate", 1.5);
+    engine.get_globals().set("fee", 20);
+
+    seconds = best_of(3, [&]() {
+      for(std::size_t i = 0; i < SLOW_ROWS; i++) {
+        engine.get_globals().set("x", rows[i]);
+        (void)engine.run(source);
+      }
+    });
+    report("Engine::run per row", seconds, SLOW_ROWS, "rows");
+  }
+
+  auto [program, error] = compile("<bench>", FORMULA);
+  if(!program) return;
+
+  seconds = best_of(3, [&]() { (void)evaluate_rows(*program, rows.data(), ROWS); });
+  report("Program::evaluate", seconds, ROWS, "rows");
+
+  // one program shared by every thread, each with its own bindings
+  unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+
+  for(unsigned threads : { 2u, 4u, 8u }) {
+    if(threads > 2 * cores) break;
+
+    seconds = best_of(3, [&]() {
+      std::vector<std::thread> workers;
+      std::size_t share = ROWS / threads;
+
+      for(unsigned t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() { (void)evaluate_rows(*program, rows.data() + t * share, share); });
+      }
+
+      for(std::thread& worker : workers) worker.join();
+    });
+    report(std::string("Program::evaluate, ") + std::to_string(threads) + " threads", seconds, ROWS, "rows");
+  }
+}
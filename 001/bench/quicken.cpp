@@ -0,0 +1,52 @@
+#include <cstdio>
+#include <memory>
+#include <string>
+#include "bench.h"
+#include "../src/arena.h"
+#include "../src/context.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+#include "../src/resolver.h"
+#include "../src/source.h"
+#include "../src/token_stream.h"
+#include "../src/state/interpreter.h"
+#include "../src/state/symbol_table.h"
+
+// the tree walker with and without operand quickening, on scripts that run
+// the same binary operations over and over
+
+static const char* SCRIPTS[][2] = {
+  { "for, sum", "var s = 0\nfor i = 0 to 1000000 do var s = s + i" },
+  { "while, counter", "var n = 0\nwhile n < 1000000 do var n = n + 1" },
+  { "for, arithmetic", "var x = 1\nfor i = 1 to 1000000 do var x = (x * 3 + i) % 1000003 - i / 7 ^ 2" },
+};
+
+void bench_quicken() {
+  for(const auto& [name, text] : SCRIPTS) {
+    auto source = SourceManager::instance().add("<bench>", text);
+
+    for(bool quickening : { false, true }) {
+      AstArena arena;
+      Lexer lexer(source);
+      TokenStream tokens(lexer);
+      Parser parser(tokens, arena);
+      auto ast = parser.parse();
+      if(!ast) return;
+
+      auto table = std::make_shared<SymbolTable>();
+      Resolver::resolve(ast.value(), *table);
+
+      Context context("<bench>");
+      context.symbol_table = table;
+      Interpreter interpreter(quickening);
+
+      double seconds = best_of(3, [&]() { (void)interpreter.visit(ast.value(), context); });
+      report(std::string(name) + (quickening ? ", quickened" : ", generic"), seconds, 1e6, "iters");
+
+      if(quickening) {
+        const QuickenStats& stats = interpreter.get_quicken_stats();
+        std::printf("    %zu operands quickened, %zu deoptimized\n", stats.quickened, stats.deoptimized);
+      }
+    }
+  }
+}
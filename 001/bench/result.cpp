@@ -0,0 +1,89 @@
+#include <cstdio>
+#include <memory>
+#include <string>
+#include "bench.h"
+#include "../src/arena.h"
+#include "../src/context.h"
+#include "../src/lexer.h"
+#include "../src/parser.h"
+#include "../src/resolver.h"
+#include "../src/source.h"
+#include "../src/token_stream.h"
+#include "../src/state/interpreter.h"
+#include "../src/state/symbol_table.h"
+
+// what passing results between parser and interpreter functions costs per
+// node, on the success path and when an error unwinds a deep expression
+
+static std::string repeat_lines(const std::string& line, int count) {
+  std::string text;
+  for(int i = 0; i < count; i++) text += line + "\n";
+  return text;
+}
+
+// 1 + (1 + (... (x / d))) with the division innermost
+static std::string nested_division(int depth, const char* divisor) {
+  std::string expr = std::string("x / ") + divisor;
+  for(int i = 0; i < depth; i++) expr = std::string("1 + (") + expr + ")";
+  return expr;
+}
+
+// each of the reps measurements runs the program `inner` times. every run
+// is checked to succeed, or to fail when error is set
+static void bench_program(const std::string& name, const std::string& text, bool error, int reps, int inner) {
+  auto source = SourceManager::instance().add("<bench>", text);
+
+  AstArena arena;
+  Lexer lexer(source);
+  TokenStream tokens(lexer);
+  Parser parser(tokens, arena);
+  auto ast = parser.parse();
+
+  if(!ast) {
+    std::printf("  parse error: %s\n", ast.get_error()->as_string().c_str());
+    return;
+  }
+
+  std::size_t nodes = arena.get_node_count();
+
+  bool unexpected = false;
+
+  double parse = best_of(reps, [&]() {
+    for(int i = 0; i < inner; i++) {
+      AstArena arena;
+      Lexer lexer(source);
+      TokenStream tokens(lexer);
+      Parser parser(tokens, arena);
+      if(!parser.parse()) unexpected = true;
+    }
+  });
+
+  auto table = std::make_shared<SymbolTable>();
+  table->set("x", 7);
+  Resolver::resolve(ast.value(), *table);
+
+  Context context("<bench>");
+  context.symbol_table = table;
+  Interpreter interpreter;
+
+  double eval = best_of(reps, [&]() {
+    for(int i = 0; i < inner; i++) {
+      bool failed = !interpreter.visit(ast.value(), context);
+      if(failed != error) unexpected = true;
+    }
+  });
+
+  if(unexpected) {
+    std::printf("  %-40s unexpected %s\n", name.c_str(), error ? "success" : "error");
+    return;
+  }
+
+  std::printf("  %-40s %10.1f ns/node parse  %8.1f ns/node eval  (%zu nodes)\n",
+    name.c_str(), parse * 1e9 / nodes / inner, eval * 1e9 / nodes / inner, nodes);
+}
+
+void bench_result() {
+  bench_program("flat arithmetic", repeat_lines("x + 3 * 2 - (x % 7) / 3 < 9 and x >= 1", 50000), false, 5, 1);
+  bench_program("nested 200, success", repeat_lines(nested_division(200, "2"), 500), false, 5, 1);
+  bench_program("nested 200, error", nested_division(200, "0"), true, 5, 500);
+}
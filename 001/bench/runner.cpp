@@ -0,0 +1,55 @@
+#include <string>
+#include <vector>
+#include "bench.h"
+#include "../src/engine.h"
+#include "../src/exception.h"
+#include "../src/runner.h"
+
+// many small independent scripts: one engine running them in turn, reset
+// between jobs, against a BatchRunner with more and more workers
+
+// loop bodies are a single statement, the last one steps a fibonacci pair
+static const char* SCRIPTS[] = {
+  "var total = 0; for i = 1 to n do var total = total + i * rate; total",
+  "if n > 50 then n * rate - 20 elif n > 10 then n * rate else 0",
+  "var a = 1; var b = 1; for i = 1 to n / 4 do var b = a + (var a = b); b",
+};
+
+// every job must have run to a value
+static void require_values(const std::vector<RunType>& results, const char* what) {
+  for(const auto& [value, error] : results) {
+    require(!error, std::string(what) + ": " + (error ? error->as_string() : ""));
+    require(value.has_value(), std::string(what) + ": a job gave no value");
+  }
+}
+
+void bench_runner() {
+  const std::size_t JOBS = 20000;
+  std::vector<Job> jobs;
+  jobs.reserve(JOBS);
+
+  for(std::size_t i = 0; i < JOBS; i++) {
+    jobs.push_back({ "<bench>", SCRIPTS[i % 3], { { "n", (double)(i % 100) }, { "rate", 1.5 } } });
+  }
+
+  std::vector<RunType> results(JOBS);
+
+  double seconds = best_of(3, [&]() {
+    Engine engine;
+
+    for(std::size_t i = 0; i < JOBS; i++) {
+      engine.reset();
+      for(const auto& [name, value] : jobs[i].bindings) engine.get_globals().set(name, value);
+      results[i] = engine.run(jobs[i].name, jobs[i].source);
+    }
+  });
+  require_values(results, "one engine");
+  report("one engine, serial", seconds, JOBS, "jobs");
+
+  for(unsigned threads : { 1u, 2u, 4u, 8u, 16u }) {
+    BatchRunner runner(threads);
+    seconds = best_of(3, [&]() { results = runner.run(jobs); });
+    require_values(results, "BatchRunner");
+    report(std::string("BatchRunner, ") + std::to_string(threads) + " threads", seconds, JOBS, "jobs");
+  }
+}
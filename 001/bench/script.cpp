@@ -0,0 +1,43 @@
+#include <cstdio>
+#include <string>
+#include "bench.h"
+#include "../src/driver.h"
+#include "../src/source.h"
+
+// throughput of batch script execution (basicpl <file>) on a large
+// generated script, output discarded
+
+static std::string make_script(int lines) {
+  std::string text = "var x = 0\n";
+
+  for(int i = 0; i < lines; i++) {
+    text += std::string("var x = x + ") + std::to_string(i % 97) + " * 2 - (x % 7) / 3\n";
+  }
+
+  return text;
+}
+
+void bench_script() {
+  const int lines = 100000;
+  std::string path = "basicpl_bench_script.bpl";
+  std::string text = make_script(lines);
+
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  std::fwrite(text.data(), 1, text.size(), file);
+  std::fclose(file);
+
+  std::FILE* null_out = std::fopen("/dev/null", "wb");
+  if(!null_out) null_out = std::tmpfile();
+
+  double seconds = best_of(3, [&]() {
+    auto source = load_script(path);
+    OutputBuffer out(null_out);
+    run_script(source, out);
+  });
+
+  report(std::string("file, ") + std::to_string(lines) + " lines", seconds, lines, "lines");
+  report(std::string("file, ") + std::to_string(text.size() >> 10) + " KiB", seconds, text.size() / 1048576.0, "MiB");
+
+  std::fclose(null_out);
+  std::remove(path.c_str());
+}
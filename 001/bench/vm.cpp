@@ -0,0 +1,82 @@
+#include <cstdio>
+#include <string>
+#include "bench.h"
+#include "../src/driver.h"
+#include "../src/lexer.h"
+#include "../src/source.h"
+
+// the three backends against each other on loop heavy scripts, where
+// evaluation rather than parsing dominates
+
+struct LoopScript {
+  const char* name;
+  const char* text;
+  double iterations;
+};
+
+static const LoopScript SCRIPTS[] = {
+  { "for, sum", "var s = 0\nfor i = 0 to 1000000 do var s = s + i\ns", 1e6 },
+  { "while, counter", "var n = 0\nwhile n < 1000000 do var n = n + 1\nn", 1e6 },
+  {
+    "nested for, if",
+    "var c = 0\n"
+    "for i = 0 to 1000 do for j = 0 to 1000 do if (i + j) % 3 == 0 then var c = c + 1 else var c = c - 1\n"
+    "c",
+    1e6
+  },
+  {
+    "for, arithmetic",
+    "var x = 1\nfor i = 1 to 1000000 do var x = (x * 3 + i) % 1000003 - i / 7 ^ 2\nx",
+    1e6
+  },
+  {
+    "while, and/or condition",
+    "var n = 0\nwhile n < 1000000 and (n % 3 == 0 or n % 3 > 0) do var n = n + 1\nn",
+    1e6
+  },
+  {
+    "for, if and/or/not",
+    "var c = 0\n"
+    "for i = 0 to 1000000 do if i % 2 == 0 and not (i % 3 == 0) or i % 5 == 0 then var c = c + 1 else var c = c - 1\n"
+    "c",
+    1e6
+  },
+  {
+    "for, wide expression",
+    "var y = 0\nfor i = 0 to 1000000 do var y = (i * 2 + 3) * (i - 1) / 4 + (i % 7) * 2 - y / 3 + (i < 500000)\ny",
+    1e6
+  },
+};
+
+const char* backend_name(Backend backend) {
+  switch(backend) {
+    case BACKEND_VM: return "vm";
+    case BACKEND_CLOSURE: return "closure";
+    default: return "tree";
+  }
+}
+
+static double last_value(const RunType& result) {
+  if(!result.first) return 0;
+  return std::get<Number>(result.first.value()).get_value();
+}
+
+void bench_vm() {
+  for(const LoopScript& script : SCRIPTS) {
+    auto source = SourceManager::instance().add("<bench>", script.text);
+
+    for(Backend backend : { BACKEND_TREE, BACKEND_VM, BACKEND_CLOSURE }) {
+      RunOptions options;
+      options.backend = backend;
+      double value = 0;
+
+      double seconds = best_of(3, [&]() {
+        value = last_value(run(source, options));
+      });
+
+      std::string name = std::string(script.name) + ", " + backend_name(backend);
+      report(name, seconds, script.iterations, "iters");
+      std::printf("    result %g\n", value);
+    }
+  }
+}
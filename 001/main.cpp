@@ -1,38 +1,106 @@
-#include <iostream>
-#include <sstream>
-#include "src/lexer.h"
-
-
-auto handle_number = [](const auto& inner) -> void {
-  if constexpr (std::is_same_v<std::decay_t<decltype(inner)>, double>) {
-    std::ostringstream oss;
-    oss << inner;
-    std::cout << oss.str() << '\n';
-  }
-};
-
-auto handle_nodes = [](const auto& val) -> void {
-  using T = std::decay_t<decltype(val)>;
-
-  if constexpr (std::is_same_v<T, std::string>) {
-    std::cout << val << '\n';
-  } else if constexpr (std::is_same_v<T, Number>) {
-    std::visit(handle_number, val.get_value());
-  }
-};
-
-int main() {
-  std::string input;
-
-  do {
-    std::cout << "program (type quit to quit) > ";
-    std::getline(std::cin, input);
-    const auto&[result, error] = run("<stdin>", input);
-
-    if(error) { // if theres an error print it as string
-      std::cout << error->as_string() << '\n'; 
-    } else if(result) {
-      std::visit(handle_nodes, result.value());
-    }
-  } while (input != "quit");
-}
\ No newline at end of file
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "src/driver.h"
+#include "src/engine.h"
+#include "src/lexer.h"
+#include "src/source.h"
+
+// basicpl            interactive prompt
+// basicpl <file>     run a script file
+// basicpl -          run a script read from stdin
+// basicpl --csv <data> --expr <file>
+//                    run a script once per record of a csv file
+//
+// --vm               run on the bytecode vm instead of the tree walker
+// --closure          run the ast compiled into closures
+// --max-depth=N      reject expressions nested deeper than N levels
+// --threads=N        evaluate N chunks of csv records at once
+int main(int argc, char** argv) {
+  RunOptions options;
+  std::string csv_path, expr_path;
+  unsigned threads = 1;
+  int arg = 1;
+
+  for(; arg < argc && std::strncmp(argv[arg], "--", 2) == 0; arg++) {
+    if(std::strcmp(argv[arg], "--vm") == 0) {
+      options.backend = BACKEND_VM;
+    } else if(std::strcmp(argv[arg], "--closure") == 0) {
+      options.backend = BACKEND_CLOSURE;
+    } else if(std::strncmp(argv[arg], "--max-depth=", 12) == 0) {
+      const char* first = argv[arg] + 12;
+      const char* last = first + std::strlen(first);
+      auto [end, error] = std::from_chars(first, last, options.max_depth);
+
+      if(error != std::errc() || end != last || options.max_depth == 0) {
+        std::cerr << "basicpl: bad depth '" << first << "'\n";
+        return 1;
+      }
+    } else if(std::strcmp(argv[arg], "--csv") == 0 || std::strcmp(argv[arg], "--expr") == 0) {
+      if(arg + 1 == argc) {
+        std::cerr << "basicpl: " << argv[arg] << " needs a file\n";
+        return 1;
+      }
+
+      std::string& path = (std::strcmp(argv[arg], "--csv") == 0) ? csv_path : expr_path;
+      path = argv[++arg];
+    } else if(std::strncmp(argv[arg], "--threads=", 10) == 0) {
+      const char* first = argv[arg] + 10;
+      const char* last = first + std::strlen(first);
+      auto [end, error] = std::from_chars(first, last, threads);
+
+      if(error != std::errc() || end != last || threads == 0) {
+        std::cerr << "basicpl: bad thread count '" << first << "'\n";
+        return 1;
+      }
+    } else {
+      std::cerr << "basicpl: unknown option '" << argv[arg] << "'\n";
+      return 1;
+    }
+  }
+
+  if(!csv_path.empty() || !expr_path.empty()) {
+    if(csv_path.empty() || expr_path.empty()) {
+      std::cerr << "basicpl: --csv and --expr go together\n";
+      return 1;
+    }
+
+    auto data = SourceManager::instance().add_file(csv_path);
+    auto script = load_script(expr_path);
+
+    if(!data || !script) {
+      std::cerr << "basicpl: cannot read '" << (data ? expr_path : csv_path) << "'\n";
+      return 1;
+    }
+
+    OutputBuffer out(stdout);
+    return run_csv(data, script, out, options, threads) ? 0 : 1;
+  }
+
+  if(arg < argc) {
+    std::string path = argv[arg];
+    auto source = load_script(path);
+
+    if(!source) {
+      std::cerr << "basicpl: cannot read '" << path << "'\n";
+      return 1;
+    }
+
+    OutputBuffer out(stdout);
+    return run_script(source, out, options) ? 0 : 1;
+  }
+
+  std::string input;
+  OutputBuffer out(stdout);
+  Engine engine;
+
+  do {
+    std::cout << "program (type quit to quit) > " << std::flush;
+    if(!std::getline(std::cin, input)) break;
+
+    out.write_result(engine.run("<stdin>", input, options));
+    out.flush();
+  } while (input != "quit");
+}
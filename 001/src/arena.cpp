@@ -0,0 +1,33 @@
+#include "arena.h"
+#include <algorithm>
+
+void* AstArena::allocate(std::size_t size, std::size_t align) {
+  std::size_t padding = (align - reinterpret_cast<std::uintptr_t>(cur) % align) % align;
+
+  if(!cur || padding + size > left) {
+    // oversized requests get a block of their own
+    std::size_t block = std::max(BLOCK_SIZE, size + align);
+
+    blocks.push_back(std::make_unique_for_overwrite<std::byte[]>(block));
+    if(blocks.size() == 1) first_size = block;
+    cur = blocks.back().get();
+    left = block;
+    padding = (align - reinterpret_cast<std::uintptr_t>(cur) % align) % align;
+  }
+
+  void* result = cur + padding;
+  cur += padding + size;
+  left -= padding + size;
+  bytes_used += size;
+
+  return result;
+}
+
+void AstArena::reset() {
+  if(blocks.size() > 1) blocks.resize(1);
+
+  cur = blocks.empty() ? nullptr : blocks.front().get();
+  left = blocks.empty() ? 0 : first_size;
+  node_count = 0;
+  bytes_used = 0;
+}
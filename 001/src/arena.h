@@ -0,0 +1,66 @@
+#ifndef ARENA
+#define ARENA
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// bump allocator that owns every node of one parse. nodes are never freed
+// one by one: the whole tree goes away with the arena, so anything placed
+// here must be trivially destructible
+class AstArena {
+private:
+  static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+
+  std::vector<std::unique_ptr<std::byte[]>> blocks{};
+  std::byte* cur = nullptr;
+  std::size_t left = 0;
+  std::size_t first_size = 0;
+
+  std::size_t node_count = 0;
+  std::size_t bytes_used = 0;
+
+  void* allocate(std::size_t size, std::size_t align);
+
+public:
+  AstArena() = default;
+  AstArena(const AstArena&) = delete;
+  AstArena& operator=(const AstArena&) = delete;
+  AstArena(AstArena&&) = default;
+  AstArena& operator=(AstArena&&) = default;
+
+  template<typename T, typename... Args>
+  T* make(Args&&... args) {
+    static_assert(std::is_trivially_destructible_v<T>, "arena objects are never destroyed");
+
+    node_count++;
+    return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  }
+
+  // drops every object at once but keeps the first block, so the next
+  // parse into this arena starts without allocating
+  void reset();
+
+  // copies items into the arena, used for child lists
+  template<typename T>
+  std::span<T> make_array(const std::vector<T>& items) {
+    static_assert(std::is_trivially_copyable_v<T>, "arena arrays are copied bytewise");
+
+    if(items.empty()) return {};
+
+    T* data = static_cast<T*>(allocate(sizeof(T) * items.size(), alignof(T)));
+    std::uninitialized_copy(items.begin(), items.end(), data);
+
+    return { data, items.size() };
+  }
+
+  inline std::size_t get_node_count() const { return node_count; }
+  inline std::size_t get_bytes_used() const { return bytes_used; }
+  inline std::size_t get_block_count() const { return blocks.size(); }
+};
+
+#endif
@@ -0,0 +1,641 @@
+#include "batch.h"
+#include "../exception.h"
+#include "../state/interpreter.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <optional>
+#include <string>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// while compiling, a source is tagged with its kind in the top bits. the
+// tags are replaced by the final indices once all of them are known
+static constexpr std::uint32_t COLUMN_SOURCE = 1u << 30;
+static constexpr std::uint32_t REGISTER_SOURCE = 2u << 30;
+static constexpr std::uint32_t SOURCE_INDEX = COLUMN_SOURCE - 1;
+
+static Failure unsupported(const ASTNode* node, const std::string& what) {
+  return fail(std::make_shared<Exception>(
+    node->get_pos_start(), node->get_pos_end(),
+    "Compile Error", what + " cannot be evaluated in batches"
+  ));
+}
+
+// kernels
+
+// every x86-64 target has sse2. compilers do not vectorize the loops that
+// turn a comparison of doubles into a double or test a divisor for zero,
+// so those are written two lanes at a time here. elsewhere they stay
+// plain loops, and the last odd row of a block always does
+#ifdef __SSE2__
+
+// all ones in the lanes where OP holds, all zeros in the others. and/or
+// test their operands for not being 0, which like != holds for nan
+template<BinaryOp OP>
+static inline __m128d lanes(__m128d a, __m128d b) {
+  if constexpr(OP == BIN_EE)  return _mm_cmpeq_pd(a, b);
+  if constexpr(OP == BIN_NE)  return _mm_cmpneq_pd(a, b);
+  if constexpr(OP == BIN_LT)  return _mm_cmplt_pd(a, b);
+  if constexpr(OP == BIN_GT)  return _mm_cmpgt_pd(a, b);
+  if constexpr(OP == BIN_LTE) return _mm_cmple_pd(a, b);
+  if constexpr(OP == BIN_GTE) return _mm_cmpge_pd(a, b);
+
+  __m128d zero = _mm_setzero_pd();
+  if constexpr(OP == BIN_AND) return _mm_and_pd(_mm_cmpneq_pd(a, zero), _mm_cmpneq_pd(b, zero));
+  if constexpr(OP == BIN_OR)  return _mm_or_pd(_mm_cmpneq_pd(a, zero), _mm_cmpneq_pd(b, zero));
+}
+
+#endif
+
+static constexpr bool yields_truth(BinaryOp op) {
+  return op >= BIN_EE;
+}
+
+// whether any of the n values is 0
+static bool any_zero(const double* values, std::size_t n) {
+  std::size_t i = 0;
+  bool zero = false;
+
+#ifdef __SSE2__
+  __m128d found = _mm_setzero_pd();
+
+  for(; i + 2 <= n; i += 2) {
+    found = _mm_or_pd(found, _mm_cmpeq_pd(_mm_loadu_pd(values + i), _mm_setzero_pd()));
+  }
+
+  zero = _mm_movemask_pd(found) != 0;
+#endif
+
+  for(; i < n; i++) zero |= values[i] == 0;
+  return zero;
+}
+
+template<BinaryOp OP>
+static bool binary_kernel(const double* a, const double* b, const double*, double* out, std::size_t n) {
+  std::size_t i = 0;
+
+#ifdef __SSE2__
+  if constexpr(yields_truth(OP)) {
+    // a lane of all ones masked down to the bits of 1.0
+    __m128d one = _mm_set1_pd(1);
+
+    for(; i + 2 <= n; i += 2) {
+      __m128d holds = lanes<OP>(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i));
+      _mm_storeu_pd(out + i, _mm_and_pd(holds, one));
+    }
+  }
+#endif
+
+  for(; i < n; i++) out[i] = apply_binary<OP>(a[i], b[i]);
+
+  // the quotient loop stays free of the test, so it still vectorizes
+  if constexpr(OP == BIN_DIV || OP == BIN_MOD) return any_zero(b, n);
+  return false;
+}
+
+template<UnaryOp OP>
+static bool unary_kernel(const double* a, const double*, const double*, double* out, std::size_t n) {
+  for(std::size_t i = 0; i < n; i++) out[i] = apply_unary<OP>(a[i]);
+  return false;
+}
+
+// a is the condition, b the value where it holds and c the one where not
+static bool select_kernel(const double* a, const double* b, const double* c, double* out, std::size_t n) {
+  std::size_t i = 0;
+
+#ifdef __SSE2__
+  for(; i + 2 <= n; i += 2) {
+    __m128d holds = _mm_cmpneq_pd(_mm_loadu_pd(a + i), _mm_setzero_pd());
+    __m128d chosen = _mm_and_pd(holds, _mm_loadu_pd(b + i));
+    _mm_storeu_pd(out + i, _mm_or_pd(chosen, _mm_andnot_pd(holds, _mm_loadu_pd(c + i))));
+  }
+#endif
+
+  for(; i < n; i++) out[i] = (a[i] != 0) ? b[i] : c[i];
+  return false;
+}
+
+static Kernel binary_kernel_of(BinaryOp op) {
+  switch(op) {
+    case BIN_ADD: return binary_kernel<BIN_ADD>;
+    case BIN_SUB: return binary_kernel<BIN_SUB>;
+    case BIN_MUL: return binary_kernel<BIN_MUL>;
+    case BIN_DIV: return binary_kernel<BIN_DIV>;
+    case BIN_POW: return binary_kernel<BIN_POW>;
+    case BIN_MOD: return binary_kernel<BIN_MOD>;
+    case BIN_EE: return binary_kernel<BIN_EE>;
+    case BIN_NE: return binary_kernel<BIN_NE>;
+    case BIN_LT: return binary_kernel<BIN_LT>;
+    case BIN_GT: return binary_kernel<BIN_GT>;
+    case BIN_LTE: return binary_kernel<BIN_LTE>;
+    case BIN_GTE: return binary_kernel<BIN_GTE>;
+    case BIN_AND: return binary_kernel<BIN_AND>;
+    case BIN_OR: return binary_kernel<BIN_OR>;
+  }
+
+  return nullptr;
+}
+
+// mask kernels
+
+#ifdef __SSE2__
+
+// row bytes of 8 rows whose truth is bits, bit i for byte i
+static constexpr std::array<std::uint64_t, 256> make_row_bytes() {
+  std::array<std::uint64_t, 256> bytes{};
+
+  for(std::size_t bits = 0; bits < 256; bits++) {
+    for(std::size_t i = 0; i < 8; i++) bytes[bits] |= (std::uint64_t)((bits >> i) & 1) << (8 * i);
+  }
+
+  return bytes;
+}
+
+static constexpr std::array<std::uint64_t, 256> ROW_BYTES = make_row_bytes();
+
+// writes the mask of rows [0, n - n % 8) eight at a time: the sign bits of
+// four lane masks from test(row) gathered into a byte, which is spread out
+// to a byte per row. returns the first row left to the caller
+template<typename Test>
+static std::size_t mask_lanes(std::uint8_t* out, std::size_t n, Test&& test) {
+  std::size_t i = 0;
+
+  for(; i + 8 <= n; i += 8) {
+    int bits = 0;
+    for(std::size_t k = 0; k < 8; k += 2) bits |= _mm_movemask_pd(test(i + k)) << k;
+
+    std::memcpy(out + i, &ROW_BYTES[bits], 8);
+  }
+
+  return i;
+}
+
+#endif
+
+template<BinaryOp OP>
+static void compare_kernel(const double* a, const double* b, std::uint8_t* out, std::size_t n) {
+  std::size_t i = 0;
+
+#ifdef __SSE2__
+  i = mask_lanes(out, n, [&](std::size_t row) {
+    return lanes<OP>(_mm_loadu_pd(a + row), _mm_loadu_pd(b + row));
+  });
+#endif
+
+  for(; i < n; i++) out[i] = apply_binary<OP>(a[i], b[i]);
+}
+
+// a value used as a condition
+static void truth_kernel(const double* a, const double*, std::uint8_t* out, std::size_t n) {
+  std::size_t i = 0;
+
+#ifdef __SSE2__
+  i = mask_lanes(out, n, [&](std::size_t row) {
+    return _mm_cmpneq_pd(_mm_loadu_pd(a + row), _mm_setzero_pd());
+  });
+#endif
+
+  for(; i < n; i++) out[i] = a[i] != 0;
+}
+
+static void and_kernel(const std::uint8_t* a, const std::uint8_t* b, std::uint8_t* out, std::size_t n) {
+  for(std::size_t i = 0; i < n; i++) out[i] = a[i] & b[i];
+}
+
+static void or_kernel(const std::uint8_t* a, const std::uint8_t* b, std::uint8_t* out, std::size_t n) {
+  for(std::size_t i = 0; i < n; i++) out[i] = a[i] | b[i];
+}
+
+static void invert_kernel(const std::uint8_t* a, const std::uint8_t*, std::uint8_t* out, std::size_t n) {
+  for(std::size_t i = 0; i < n; i++) out[i] = a[i] ^ 1;
+}
+
+// nullptr for the operators that are not comparisons
+static CompareKernel compare_kernel_of(BinaryOp op) {
+  switch(op) {
+    case BIN_EE: return compare_kernel<BIN_EE>;
+    case BIN_NE: return compare_kernel<BIN_NE>;
+    case BIN_LT: return compare_kernel<BIN_LT>;
+    case BIN_GT: return compare_kernel<BIN_GT>;
+    case BIN_LTE: return compare_kernel<BIN_LTE>;
+    case BIN_GTE: return compare_kernel<BIN_GTE>;
+    default: return nullptr;
+  }
+}
+
+// end kernels
+
+// columns
+
+Columns::Columns(const Program& program): by_slot(program.get_layout().size()) {}
+
+// end columns
+
+// batch program
+
+BatchCompileResult BatchProgram::compile(const std::shared_ptr<const Program>& program) {
+  return compile(program, false);
+}
+
+BatchCompileResult BatchProgram::compile_filter(const std::shared_ptr<const Program>& program) {
+  return compile(program, true);
+}
+
+BatchCompileResult BatchProgram::compile(const std::shared_ptr<const Program>& program, bool filtering) {
+  // only the ids of this compile's errors are looked at
+  ErrorTable::clear();
+
+  std::shared_ptr<BatchProgram> batch(new BatchProgram(program));
+  batch->filtering = filtering;
+  const ASTNode* root = program->get_root();
+
+  if(root->kind == NODE_STATEMENTS) {
+    const auto& statements = static_cast<const StatementsNode*>(root)->statements;
+    if(statements.size() != 1) {
+      return { nullptr, ErrorTable::get(unsupported(root, "a program that is not a single expression").id) };
+    }
+
+    root = statements.front();
+  }
+
+  Result<std::uint32_t> result = filtering ? batch->compile_mask(root) : batch->compile_node(root);
+  if(!result) return { nullptr, result.get_error() };
+
+  // constants come first, then the columns, then the registers
+  std::uint32_t constant_count = batch->constants.size() / BATCH_SIZE;
+  std::uint32_t column_count = batch->column_slots.size();
+
+  auto flat = [&](std::uint32_t source) {
+    std::uint32_t index = source & SOURCE_INDEX;
+
+    if(source & REGISTER_SOURCE) return constant_count + column_count + index;
+    if(source & COLUMN_SOURCE) return constant_count + index;
+    return index;
+  };
+
+  for(BatchStep& step : batch->steps) {
+    step.a = flat(step.a);
+    step.b = flat(step.b);
+    step.c = flat(step.c);
+  }
+
+  for(MaskStep& step : batch->mask_steps) {
+    if(step.compare) {
+      step.a = flat(step.a);
+      step.b = flat(step.b);
+    }
+  }
+
+  for(std::uint32_t& divisor : batch->divisors) divisor = flat(divisor);
+  // the result of a filter is a mask register and stays as it is
+  batch->result = filtering ? result.value() : flat(result.value());
+
+  return { std::move(batch), nullptr };
+}
+
+Result<std::uint32_t> BatchProgram::compile_node(const ASTNode* node) {
+  switch(node->kind) {
+    case NODE_NUMBER:
+      return constant(static_cast<const NumberNode*>(node)->value);
+    case NODE_VAR_ACCESS: {
+      const VarAccessNode* access = static_cast<const VarAccessNode*>(node);
+
+      // builtins never change, so they are constants rather than columns
+      if(is_builtin(access->var_name)) return constant(*program->get_layout().load(access->slot));
+      return column(access->slot);
+    }
+    case NODE_BIN_OP:
+      return compile_bin_op(*static_cast<const BinOpNode*>(node));
+    case NODE_UNARY_OP:
+      return compile_unary_op(*static_cast<const UnaryOpNode*>(node));
+    case NODE_IF:
+      return compile_if(*static_cast<const IfNode*>(node));
+    case NODE_VAR_ASSIGN:
+      return unsupported(node, "an assignment");
+    default:
+      return unsupported(node, "a loop");
+  }
+}
+
+Result<std::uint32_t> BatchProgram::compile_bin_op(const BinOpNode& node) {
+  Result<std::uint32_t> left = compile_node(node.left_node);
+  if(!left) return left;
+
+  Result<std::uint32_t> right = compile_node(node.right_node);
+  if(!right) return right;
+
+  if(node.op == BIN_DIV || node.op == BIN_MOD) divisors.push_back(right.value());
+
+  return emit(binary_kernel_of(node.op), left.value(), right.value());
+}
+
+Result<std::uint32_t> BatchProgram::compile_unary_op(const UnaryOpNode& node) {
+  Result<std::uint32_t> operand = compile_node(node.node);
+  if(!operand) return operand;
+
+  // every value in a batch is a number, so '+' has nothing to do
+  switch(node.op) {
+    case UN_MINUS: return emit(unary_kernel<UN_MINUS>, operand.value(), operand.value());
+    case UN_NOT: return emit(unary_kernel<UN_NOT>, operand.value(), operand.value());
+    default: return operand;
+  }
+}
+
+Result<std::uint32_t> BatchProgram::compile_if(const IfNode& node) {
+  // without an else some rows would have no value
+  if(!node.else_case) return unsupported(&node, "an if without an else");
+
+  Result<std::uint32_t> result = compile_node(node.else_case);
+  if(!result) return result;
+
+  // from the last case back, each selects between its own value and the
+  // cases after it
+  for(auto it = node.cases.rbegin(); it != node.cases.rend(); ++it) {
+    Result<std::uint32_t> condition = compile_node(it->condition);
+    if(!condition) return condition;
+
+    Result<std::uint32_t> expr = compile_node(it->expr);
+    if(!expr) return expr;
+
+    result = emit(select_kernel, condition.value(), expr.value(), result.value());
+  }
+
+  return result;
+}
+
+Result<std::uint32_t> BatchProgram::compile_mask(const ASTNode* node) {
+  if(node->kind == NODE_BIN_OP) {
+    const BinOpNode& bin_op = *static_cast<const BinOpNode*>(node);
+
+    if(bin_op.op == BIN_AND || bin_op.op == BIN_OR) {
+      Result<std::uint32_t> left = compile_mask(bin_op.left_node);
+      if(!left) return left;
+
+      Result<std::uint32_t> right = compile_mask(bin_op.right_node);
+      if(!right) return right;
+
+      return emit_mask(nullptr, (bin_op.op == BIN_AND) ? and_kernel : or_kernel, left.value(), right.value());
+    }
+
+    if(CompareKernel compare = compare_kernel_of(bin_op.op)) {
+      Result<std::uint32_t> left = compile_node(bin_op.left_node);
+      if(!left) return left;
+
+      Result<std::uint32_t> right = compile_node(bin_op.right_node);
+      if(!right) return right;
+
+      return emit_mask(compare, nullptr, left.value(), right.value());
+    }
+  }
+
+  if(node->kind == NODE_UNARY_OP) {
+    const UnaryOpNode& unary_op = *static_cast<const UnaryOpNode*>(node);
+
+    if(unary_op.op == UN_NOT) {
+      Result<std::uint32_t> operand = compile_mask(unary_op.node);
+      if(!operand) return operand;
+
+      return emit_mask(nullptr, invert_kernel, operand.value(), operand.value());
+    }
+
+    if(unary_op.op == UN_PLUS) return compile_mask(unary_op.node);
+  }
+
+  // anything else is a value tested for not being 0
+  Result<std::uint32_t> value = compile_node(node);
+  if(!value) return value;
+
+  return emit_mask(truth_kernel, nullptr, value.value(), value.value());
+}
+
+std::uint32_t BatchProgram::constant(double value) {
+  std::uint32_t count = constants.size() / BATCH_SIZE;
+
+  for(std::uint32_t i = 0; i < count; i++) {
+    if(std::bit_cast<std::uint64_t>(constants[i * BATCH_SIZE]) == std::bit_cast<std::uint64_t>(value)) return i;
+  }
+
+  constants.resize(constants.size() + BATCH_SIZE, value);
+  return count;
+}
+
+std::uint32_t BatchProgram::column(std::uint32_t slot) {
+  auto it = std::ranges::find(column_slots, slot);
+  if(it != column_slots.end()) return COLUMN_SOURCE | (std::uint32_t)(it - column_slots.begin());
+
+  column_slots.push_back(slot);
+  return COLUMN_SOURCE | (std::uint32_t)(column_slots.size() - 1);
+}
+
+std::uint32_t BatchProgram::emit(Kernel kernel, std::uint32_t a, std::uint32_t b, std::uint32_t c) {
+  steps.push_back({ kernel, a, b, c, register_count });
+  return REGISTER_SOURCE | register_count++;
+}
+
+std::uint32_t BatchProgram::emit_mask(CompareKernel compare, CombineKernel combine, std::uint32_t a, std::uint32_t b) {
+  mask_steps.push_back({ compare, combine, a, b, mask_count });
+  return mask_count++;
+}
+
+template<typename Emit>
+std::shared_ptr<Exception> BatchProgram::run(const Columns& columns, std::size_t rows, Emit&& emit) const {
+  ErrorTable::clear();
+
+  std::uint32_t constant_count = constants.size() / BATCH_SIZE;
+  std::uint32_t column_count = column_slots.size();
+
+  std::vector<double> registers(register_count * BATCH_SIZE);
+  std::vector<std::uint8_t> masks(mask_count * BATCH_SIZE);
+  // the result of the block, with the rows the scalar program decided
+  std::vector<double> values(filtering ? 0 : BATCH_SIZE);
+  std::vector<const double*> sources(constant_count + column_count + register_count);
+
+  for(std::uint32_t i = 0; i < constant_count; i++) sources[i] = constants.data() + i * BATCH_SIZE;
+  for(std::uint32_t i = 0; i < register_count; i++) {
+    sources[constant_count + column_count + i] = registers.data() + i * BATCH_SIZE;
+  }
+
+  bool bound = std::ranges::all_of(column_slots, [&](std::uint32_t slot) {
+    return columns.by_slot[slot].size() >= rows;
+  });
+
+  // the scalar program, for the rows the kernels cannot decide
+  std::optional<Bindings> bindings;
+
+  auto evaluate_row = [&](std::size_t row, double& value) -> std::shared_ptr<Exception> {
+    if(!bindings) bindings.emplace(program->bind());
+
+    for(std::uint32_t slot : column_slots) {
+      if(columns.by_slot[slot].size() >= rows) bindings->set(slot, columns.by_slot[slot][row]);
+    }
+
+    RunType result = program->evaluate(*bindings);
+    if(result.second) return result.second;
+
+    value = result.first ? std::get<Number>(*result.first).get_value() : -1;
+    return nullptr;
+  };
+
+  for(std::size_t start = 0; start < rows; start += BATCH_SIZE) {
+    std::size_t n = std::min(BATCH_SIZE, rows - start);
+    std::uint8_t* mask = filtering ? masks.data() + result * BATCH_SIZE : nullptr;
+
+    // a missing column is only an error in the rows that read it, so
+    // without all of them every row is left to the scalar program
+    if(!bound) {
+      for(std::size_t i = 0; i < n; i++) {
+        double value = 0;
+
+        if(auto error = evaluate_row(start + i, value)) {
+          emit(start, i, filtering ? nullptr : values.data(), mask);
+          return error;
+        }
+
+        if(filtering) {
+          mask[i] = value != 0;
+        } else {
+          values[i] = value;
+        }
+      }
+
+      emit(start, n, filtering ? nullptr : values.data(), mask);
+      continue;
+    }
+
+    for(std::uint32_t i = 0; i < column_count; i++) {
+      sources[constant_count + i] = columns.by_slot[column_slots[i]].data() + start;
+    }
+
+    bool flagged = false;
+
+    for(const BatchStep& step : steps) {
+      double* target = registers.data() + step.out * BATCH_SIZE;
+      flagged |= step.kernel(sources[step.a], sources[step.b], sources[step.c], target, n);
+    }
+
+    for(const MaskStep& step : mask_steps) {
+      std::uint8_t* target = masks.data() + step.out * BATCH_SIZE;
+
+      if(step.compare) {
+        step.compare(sources[step.a], sources[step.b], target, n);
+      } else {
+        step.combine(masks.data() + step.a * BATCH_SIZE, masks.data() + step.b * BATCH_SIZE, target, n);
+      }
+    }
+
+    // values are only copied out of their source when rows must change
+    const double* block = filtering ? nullptr : sources[result];
+
+    if(flagged) {
+      if(!filtering) {
+        std::copy_n(sources[result], n, values.data());
+        block = values.data();
+      }
+
+      for(std::size_t i = 0; i < n; i++) {
+        bool zero = std::ranges::any_of(divisors, [&](std::uint32_t divisor) { return sources[divisor][i] == 0; });
+        if(!zero) continue;
+
+        double value = 0;
+        if(auto error = evaluate_row(start + i, value)) {
+          // the rows before the failing one are still handed out
+          emit(start, i, block, mask);
+          return error;
+        }
+
+        if(filtering) {
+          mask[i] = value != 0;
+        } else {
+          values[i] = value;
+        }
+      }
+    }
+
+    emit(start, n, block, mask);
+  }
+
+  return nullptr;
+}
+
+std::shared_ptr<Exception> BatchProgram::evaluate(const Columns& columns, std::span<double> out) const {
+  return run(columns, out.size(), [&](std::size_t start, std::size_t n, const double* values, const std::uint8_t* mask) {
+    if(values) {
+      std::copy_n(values, n, out.data() + start);
+    } else {
+      for(std::size_t i = 0; i < n; i++) out[start + i] = mask[i];
+    }
+  });
+}
+
+std::shared_ptr<Exception> BatchProgram::filter(
+  const Columns& columns,
+  std::size_t rows,
+  std::span<std::uint64_t> bitmap
+) const {
+  return run(columns, rows, [&](std::size_t start, std::size_t n, const double* values, const std::uint8_t* mask) {
+    // blocks start on a word boundary, so each word is packed from 64 rows
+    // in a register and stored once
+    for(std::size_t first = 0; first < n; first += 64) {
+      std::size_t count = std::min<std::size_t>(64, n - first);
+      std::uint64_t word = 0;
+      std::size_t i = 0;
+
+#ifdef __SSE2__
+      // the sign bits of two values' tests, or of sixteen row bytes
+      // shifted up from bit 0, are taken in one movemask
+      if(values) {
+        for(; i + 2 <= count; i += 2) {
+          __m128d holds = _mm_cmpneq_pd(_mm_loadu_pd(values + first + i), _mm_setzero_pd());
+          word |= (std::uint64_t)_mm_movemask_pd(holds) << i;
+        }
+      } else {
+        for(; i + 16 <= count; i += 16) {
+          __m128i rows = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mask + first + i));
+          word |= (std::uint64_t)_mm_movemask_epi8(_mm_slli_epi16(rows, 7)) << i;
+        }
+      }
+#endif
+
+      if(values) {
+        for(; i < count; i++) word |= (std::uint64_t)(values[first + i] != 0) << i;
+      } else {
+        for(; i < count; i++) word |= (std::uint64_t)mask[first + i] << i;
+      }
+
+      bitmap[(start + first) / 64] = word;
+    }
+  });
+}
+
+std::shared_ptr<Exception> BatchProgram::select(
+  const Columns& columns,
+  std::size_t rows,
+  std::vector<std::uint32_t>& selected
+) const {
+  if(rows > MAX_SELECT_ROWS) {
+    return std::make_shared<Exception>(
+      Position(), Position(), "Runtime Error",
+      "select takes at most " + std::to_string(MAX_SELECT_ROWS) + " rows, got " + std::to_string(rows)
+    );
+  }
+
+  return run(columns, rows, [&](std::size_t start, std::size_t n, const double* values, const std::uint8_t* mask) {
+    // every row is written and only the passing ones are kept, so there is
+    // no branch on the outcome of a row
+    std::size_t count = selected.size();
+    selected.resize(count + n);
+
+    for(std::size_t i = 0; i < n; i++) {
+      selected[count] = start + i;
+      count += values ? values[i] != 0 : mask[i];
+    }
+
+    selected.resize(count);
+  });
+}
+
+// end batch program
@@ -0,0 +1,142 @@
+#ifndef BATCH
+#define BATCH
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+#include "../nodes.h"
+#include "../program.h"
+
+class Exception;
+class BatchProgram;
+
+// rows evaluated together: every operation runs over this many values at a
+// time, which keeps a block's intermediate results in the l1 cache
+constexpr std::size_t BATCH_SIZE = 1024;
+
+// the most rows select takes, each gets a std::uint32_t index
+constexpr std::size_t MAX_SELECT_ROWS = (std::size_t)UINT32_MAX + 1;
+
+// the compiled batch program, or the error that stopped compiling it
+using BatchCompileResult = std::pair<std::shared_ptr<const BatchProgram>, std::shared_ptr<Exception>>;
+
+// the input of a batch evaluation: one column of values per variable,
+// bound by the slot Program::slot_of gave it
+class Columns {
+private:
+  std::vector<std::span<const double>> by_slot;
+
+  friend class BatchProgram;
+
+public:
+  explicit Columns(const Program& program);
+
+  inline void set(std::uint32_t slot, std::span<const double> column) { by_slot[slot] = column; }
+};
+
+// one operation over a block. kernels return whether some lane needs to
+// be looked at row by row (a zero divisor)
+using Kernel = bool (*)(const double* a, const double* b, const double* c, double* out, std::size_t n);
+
+struct BatchStep {
+  Kernel kernel;
+  // operands and result index BatchProgram's sources, c is only read by selects
+  std::uint32_t a, b, c;
+  std::uint32_t out;
+};
+
+// filters keep truth values as one byte per row, 0 or 1, so a vector
+// register compares or combines eight times as many rows as it could
+// doubles
+using CompareKernel = void (*)(const double* a, const double* b, std::uint8_t* out, std::size_t n);
+using CombineKernel = void (*)(const std::uint8_t* a, const std::uint8_t* b, std::uint8_t* out, std::size_t n);
+
+// a comparison or truth test of sources (compare), or and/or/not of
+// earlier masks (combine). they run after every BatchStep of the block
+struct MaskStep {
+  CompareKernel compare;
+  CombineKernel combine;
+  // sources for compare, mask registers for combine
+  std::uint32_t a, b;
+  std::uint32_t out;
+};
+
+// a single expression made of numbers, variables, operators and ifs with
+// an else, lowered to a list of kernels that each run over a whole block
+// of rows. an if computes every branch and selects per row, and/or compute
+// both sides, so no row takes a branch of its own.
+//
+// a filter (compile_filter) only asks which rows the expression is true
+// for: its comparisons and and/or/not produce masks instead of values.
+// a row passes where the value is not 0. either kind of program can
+// evaluate, filter and select, a filter evaluates to 1 or 0.
+//
+// the kernels are plain loops the compiler vectorizes for whatever the
+// build targets, with sse2 versions of those it does not (comparisons,
+// selects and the zero divisor test). a division or modulus that meets a zero divisor flags its
+// block, and the flagged rows are evaluated again by the scalar program,
+// which decides whether the row really divides by zero (it may not have
+// taken that branch) and reports the error exactly as run() would
+class BatchProgram {
+private:
+  std::shared_ptr<const Program> program;
+  std::vector<BatchStep> steps{};
+  // sources are the constants, then the columns, then the registers steps
+  // write. constants are stored filled out to a whole block
+  std::vector<double> constants{};
+  // slot of each column source
+  std::vector<std::uint32_t> column_slots{};
+  std::uint32_t register_count = 0;
+  // index of the source holding the result
+  std::uint32_t result = 0;
+  // divisor sources of every division and modulus
+  std::vector<std::uint32_t> divisors{};
+  // set for filters, whose result is a mask register
+  bool filtering = false;
+  std::vector<MaskStep> mask_steps{};
+  std::uint32_t mask_count = 0;
+
+  BatchProgram(const std::shared_ptr<const Program>& program): program(program) {}
+
+  static BatchCompileResult compile(const std::shared_ptr<const Program>& program, bool filtering);
+
+  Result<std::uint32_t> compile_node(const ASTNode* node);
+  Result<std::uint32_t> compile_bin_op(const BinOpNode& node);
+  Result<std::uint32_t> compile_unary_op(const UnaryOpNode& node);
+  Result<std::uint32_t> compile_if(const IfNode& node);
+  Result<std::uint32_t> compile_mask(const ASTNode* node);
+  std::uint32_t constant(double value);
+  std::uint32_t column(std::uint32_t slot);
+  std::uint32_t emit(Kernel kernel, std::uint32_t a, std::uint32_t b, std::uint32_t c = 0);
+  std::uint32_t emit_mask(CompareKernel compare, CombineKernel combine, std::uint32_t a, std::uint32_t b);
+
+  // runs rows block by block. emit gets each finished block's values, or
+  // for a filter its mask, the other pointer is nullptr
+  template<typename Emit>
+  std::shared_ptr<Exception> run(const Columns& columns, std::size_t rows, Emit&& emit) const;
+
+public:
+  static BatchCompileResult compile(const std::shared_ptr<const Program>& program);
+  static BatchCompileResult compile_filter(const std::shared_ptr<const Program>& program);
+
+  // the methods below run the first rows rows of columns, and every column
+  // must hold at least that many values. they return the error of the
+  // first row that fails, nullptr if none did. rows before it are written
+
+  // one value per row into out, rows is out.size()
+  std::shared_ptr<Exception> evaluate(const Columns& columns, std::span<double> out) const;
+
+  // sets bit i % 64 of word i / 64 for every row i that passes and clears
+  // the others. bitmap holds (rows + 63) / 64 words
+  std::shared_ptr<Exception> filter(const Columns& columns, std::size_t rows, std::span<std::uint64_t> bitmap) const;
+
+  // appends the index of every row that passes to selected. the indices
+  // are 32 bits wide, half the memory of size_t, so rows may be at most
+  // MAX_SELECT_ROWS
+  std::shared_ptr<Exception> select(const Columns& columns, std::size_t rows, std::vector<std::uint32_t>& selected) const;
+};
+
+#endif
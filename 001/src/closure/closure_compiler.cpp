@@ -0,0 +1,339 @@
+#include "closure_compiler.h"
+#include "../exception.h"
+#include "../symbols.h"
+#include "../state/interpreter.h"
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+static Failure failure(const ASTNode* node, ClosureFrame& frame, const std::string& details) {
+  return fail(std::make_shared<RTException>(
+    frame.context, node->get_pos_start(), node->get_pos_end(), details
+  ));
+}
+
+static Failure not_defined(const ASTNode* node, std::uint32_t name, ClosureFrame& frame) {
+  return failure(node, frame, std::string("'") + std::string(symbol_name(name)) + "' is not defined");
+}
+
+// operands of a binary operation that need no closure of their own
+
+struct ConstOperand {
+  double value;
+
+  inline Result<Value> operator()(ClosureFrame&) const { return Value::number(value); }
+};
+
+struct SlotOperand {
+  std::uint32_t slot;
+  const VarAccessNode* node;
+
+  inline Result<Value> operator()(ClosureFrame& frame) const {
+    std::optional<double> value = frame.symbols.load(slot);
+    if(!value) return not_defined(node, node->var_name, frame);
+
+    return Value::number(value.value());
+  }
+};
+
+// an if case with the node its value is blamed on, nullptr when the branch
+// is an if itself and notes its own
+struct CompiledCase {
+  Closure condition, expr;
+  const ASTNode* origin;
+};
+
+static const ASTNode* branch_origin_of(const ASTNode* expr) {
+  const ASTNode* origin = value_origin(expr);
+  return (origin->kind == NODE_IF) ? nullptr : origin;
+}
+
+Closure ClosureCompiler::compile(const ASTNode* node, AstArena& arena) {
+  return ClosureCompiler(arena).compile_node(node);
+}
+
+template<typename F>
+Closure ClosureCompiler::wrap(F lambda) {
+  const F* state = arena.make<F>(std::move(lambda));
+
+  return {
+    [](const void* state, ClosureFrame& frame) -> Result<Value> {
+      return (*static_cast<const F*>(state))(frame);
+    },
+    state
+  };
+}
+
+// calls next with node as the operand type that reads it cheapest
+template<typename Next>
+Closure ClosureCompiler::with_operand(const ASTNode* node, Next&& next) {
+  switch(node->kind) {
+    case NODE_NUMBER:
+      return next(ConstOperand{ static_cast<const NumberNode*>(node)->value });
+    case NODE_VAR_ACCESS: {
+      auto* access = static_cast<const VarAccessNode*>(node);
+      return next(SlotOperand{ access->slot, access });
+    }
+    default:
+      return next(compile_node(node));
+  }
+}
+
+Closure ClosureCompiler::compile_node(const ASTNode* node) {
+  switch(node->kind) {
+    case NODE_NUMBER:
+      return wrap(ConstOperand{ static_cast<const NumberNode*>(node)->value });
+    case NODE_VAR_ACCESS: {
+      auto* access = static_cast<const VarAccessNode*>(node);
+      return wrap(SlotOperand{ access->slot, access });
+    }
+    case NODE_VAR_ASSIGN: return compile_var_assign(*static_cast<const VarAssignNode*>(node));
+    case NODE_BIN_OP: return compile_bin_op(*static_cast<const BinOpNode*>(node));
+    case NODE_UNARY_OP: return compile_unary_op(*static_cast<const UnaryOpNode*>(node));
+    case NODE_IF: return compile_if(*static_cast<const IfNode*>(node));
+    case NODE_FOR: return compile_for(*static_cast<const ForNode*>(node));
+    case NODE_WHILE: return compile_while(*static_cast<const WhileNode*>(node));
+    case NODE_STATEMENTS: break;
+  }
+
+  return compile_statements(*static_cast<const StatementsNode*>(node));
+}
+
+template<BinaryOp OP>
+Closure ClosureCompiler::compile_bin_op(const BinOpNode& node) {
+  // an if hands on the value of the branch that ran, so which range to blame
+  // is only known at runtime
+  const ASTNode* origin = value_origin(node.right_node);
+  bool dynamic = origin->kind == NODE_IF;
+
+  return with_operand(node.left_node, [&](auto left) {
+    return with_operand(node.right_node, [&](auto right) {
+      return wrap([left, right, origin, dynamic](ClosureFrame& frame) -> Result<Value> {
+        Result<Value> left_value = left(frame);
+        if(!left_value) return left_value;
+
+        if constexpr(OP == BIN_AND || OP == BIN_OR) {
+          if(left_value->is_true() == (OP == BIN_OR)) return Value::number(OP == BIN_OR);
+        }
+
+        Result<Value> right_value = right(frame);
+        if(!right_value) return right_value;
+
+        double right_number = right_value->as_number();
+
+        if constexpr(OP == BIN_DIV || OP == BIN_MOD) {
+          if(right_number == 0) {
+            return failure(
+              dynamic ? frame.branch_origin : origin, frame,
+              (OP == BIN_DIV) ? "division by zero" : "modulus by zero"
+            );
+          }
+        }
+
+        return Value::number(apply_binary<OP>(left_value->as_number(), right_number));
+      });
+    });
+  });
+}
+
+Closure ClosureCompiler::compile_bin_op(const BinOpNode& node) {
+  switch(node.op) {
+    case BIN_ADD: return compile_bin_op<BIN_ADD>(node);
+    case BIN_SUB: return compile_bin_op<BIN_SUB>(node);
+    case BIN_MUL: return compile_bin_op<BIN_MUL>(node);
+    case BIN_DIV: return compile_bin_op<BIN_DIV>(node);
+    case BIN_POW: return compile_bin_op<BIN_POW>(node);
+    case BIN_MOD: return compile_bin_op<BIN_MOD>(node);
+    case BIN_EE:  return compile_bin_op<BIN_EE>(node);
+    case BIN_NE:  return compile_bin_op<BIN_NE>(node);
+    case BIN_LT:  return compile_bin_op<BIN_LT>(node);
+    case BIN_GT:  return compile_bin_op<BIN_GT>(node);
+    case BIN_LTE: return compile_bin_op<BIN_LTE>(node);
+    case BIN_GTE: return compile_bin_op<BIN_GTE>(node);
+    case BIN_AND: return compile_bin_op<BIN_AND>(node);
+    case BIN_OR:  break;
+  }
+
+  return compile_bin_op<BIN_OR>(node);
+}
+
+Closure ClosureCompiler::compile_unary_op(const UnaryOpNode& node) {
+  Closure operand = compile_node(node.node);
+
+  switch(node.op) {
+    case UN_MINUS:
+      return wrap([operand](ClosureFrame& frame) -> Result<Value> {
+        Result<Value> value = operand(frame);
+        if(!value) return value;
+
+        return Value::number(apply_unary<UN_MINUS>(value->as_number()));
+      });
+    case UN_NOT:
+      return wrap([operand](ClosureFrame& frame) -> Result<Value> {
+        Result<Value> value = operand(frame);
+        if(!value) return value;
+
+        return Value::number(apply_unary<UN_NOT>(value->as_number()));
+      });
+    case UN_PLUS: break;
+  }
+
+  return wrap([operand](ClosureFrame& frame) -> Result<Value> {
+    Result<Value> value = operand(frame);
+    if(!value) return value;
+
+    return value->defined();
+  });
+}
+
+Closure ClosureCompiler::compile_var_assign(const VarAssignNode& node) {
+  Closure value = compile_node(node.value_node);
+  bool builtin = is_builtin(node.var_name);
+  const VarAssignNode* assign = &node;
+
+  return wrap([value, builtin, assign](ClosureFrame& frame) -> Result<Value> {
+    Result<Value> result = value(frame);
+    if(!result) return result;
+
+    if(builtin) {
+      return failure(
+        assign, frame,
+        std::string("cannot reassign built-in variable '") + std::string(symbol_name(assign->var_name)) + "'"
+      );
+    }
+
+    if(result->is_none()) return not_defined(assign, assign->var_name, frame);
+
+    frame.symbols.store(assign->slot, result->as_number());
+    return result;
+  });
+}
+
+Closure ClosureCompiler::compile_if(const IfNode& node) {
+  std::vector<CompiledCase> compiled;
+  for(const auto&[condition, expr] : node.cases) {
+    compiled.push_back({ compile_node(condition), compile_node(expr), branch_origin_of(expr) });
+  }
+
+  std::span<CompiledCase> cases = arena.make_array(compiled);
+  bool has_else = node.else_case != nullptr;
+  Closure else_case = has_else ? compile_node(node.else_case) : Closure{};
+  const ASTNode* else_origin = has_else ? branch_origin_of(node.else_case) : nullptr;
+
+  return wrap([cases, has_else, else_case, else_origin](ClosureFrame& frame) -> Result<Value> {
+    for(const CompiledCase& c : cases) {
+      Result<Value> condition = c.condition(frame);
+      if(!condition) return condition;
+
+      if(condition->is_true()) {
+        Result<Value> value = c.expr(frame);
+        if(!value) return value;
+
+        if(c.origin) frame.branch_origin = c.origin;
+        return value->defined();
+      }
+    }
+
+    if(has_else) {
+      Result<Value> value = else_case(frame);
+      if(!value) return value;
+
+      if(else_origin) frame.branch_origin = else_origin;
+      return value->defined();
+    }
+
+    return Value::none();
+  });
+}
+
+Closure ClosureCompiler::compile_for(const ForNode& node) {
+  Closure start = compile_node(node.start_value);
+  Closure end = compile_node(node.end_value);
+  bool has_step = node.step_value != nullptr;
+  Closure step = has_step ? compile_node(node.step_value) : Closure{};
+  Closure body = compile_node(node.body);
+  std::uint32_t slot = node.slot;
+  bool var_in_body = node.var_in_body;
+
+  return wrap([=](ClosureFrame& frame) -> Result<Value> {
+    Result<Value> start_value = start(frame);
+    if(!start_value) return start_value;
+
+    Result<Value> end_value = end(frame);
+    if(!end_value) return end_value;
+
+    double step_by = 1;
+
+    if(has_step) {
+      Result<Value> step_value = step(frame);
+      if(!step_value) return step_value;
+
+      step_by = step_value->as_number();
+    }
+
+    double i = start_value->as_number();
+    double until = end_value->as_number();
+    bool up = step_by >= 0;
+
+    if(!(up ? i < until : i > until)) return Value::none();
+
+    // same as Interpreter::visit_ForNode: a body that cannot see the
+    // variable leaves it to be stored once, when the loop stops
+    for(;;) {
+      if(var_in_body) frame.symbols.store(slot, i);
+
+      Result<Value> result = body(frame);
+      if(!result) {
+        if(!var_in_body) frame.symbols.store(slot, i);
+        return result;
+      }
+
+      double next = i + step_by;
+      if(!(up ? next < until : next > until)) break;
+      i = next;
+    }
+
+    if(!var_in_body) frame.symbols.store(slot, i);
+
+    return Value::none();
+  });
+}
+
+Closure ClosureCompiler::compile_while(const WhileNode& node) {
+  Closure condition = compile_node(node.condition);
+  Closure body = compile_node(node.body);
+
+  return wrap([condition, body](ClosureFrame& frame) -> Result<Value> {
+    while(true) {
+      Result<Value> condition_value = condition(frame);
+      if(!condition_value) return condition_value;
+
+      if(!condition_value->is_true()) break;
+
+      Result<Value> result = body(frame);
+      if(!result) return result;
+    }
+
+    return Value::none();
+  });
+}
+
+Closure ClosureCompiler::compile_statements(const StatementsNode& node) {
+  std::vector<Closure> compiled;
+  for(const ASTNode* statement : node.statements) compiled.push_back(compile_node(statement));
+
+  std::span<Closure> statements = arena.make_array(compiled);
+
+  return wrap([statements](ClosureFrame& frame) -> Result<Value> {
+    // the program evaluates to its last statement
+    Result<Value> result = Value::none();
+
+    for(const Closure& statement : statements) {
+      result = statement(frame);
+      if(!result) return result;
+    }
+
+    return result;
+  });
+}
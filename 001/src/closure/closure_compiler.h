@@ -0,0 +1,59 @@
+#ifndef CLOSURE_COMPILER
+#define CLOSURE_COMPILER
+
+#include <cstdint>
+#include "../arena.h"
+#include "../context.h"
+#include "../nodes.h"
+#include "../result.h"
+#include "../state/symbol_table.h"
+#include "../state/value.h"
+
+// what compiled closures run against
+struct ClosureFrame {
+  Context& context;
+  SymbolTable& symbols;
+  // the node the value of the last finished if came from, division by zero
+  // blames it when the divisor was an if (as in Interpreter)
+  const ASTNode* branch_origin = nullptr;
+};
+
+// a compiled node. fn is a lambda specialized for the node's operator and
+// the kinds of its operands, state holds what it captured
+struct Closure {
+  Result<Value> (*fn)(const void* state, ClosureFrame& frame);
+  const void* state;
+
+  inline Result<Value> operator()(ClosureFrame& frame) const { return fn(state, frame); }
+};
+
+// turns the ast into a tree of closures that call each other directly: no
+// accept(), no visitor and no switch on the operator per evaluation.
+// number and variable operands of binary operations are captured in place
+// rather than compiled into closures of their own. everything is placed in
+// the arena the program was parsed into, so it lives as long as the nodes
+// it blames on errors
+class ClosureCompiler {
+private:
+  AstArena& arena;
+
+  ClosureCompiler(AstArena& arena): arena(arena) {}
+
+  template<typename F> Closure wrap(F lambda);
+  template<typename Next> Closure with_operand(const ASTNode* node, Next&& next);
+  template<BinaryOp OP> Closure compile_bin_op(const BinOpNode& node);
+
+  Closure compile_node(const ASTNode* node);
+  Closure compile_bin_op(const BinOpNode& node);
+  Closure compile_unary_op(const UnaryOpNode& node);
+  Closure compile_var_assign(const VarAssignNode& node);
+  Closure compile_if(const IfNode& node);
+  Closure compile_for(const ForNode& node);
+  Closure compile_while(const WhileNode& node);
+  Closure compile_statements(const StatementsNode& node);
+
+public:
+  static Closure compile(const ASTNode* node, AstArena& arena);
+};
+
+#endif
@@ -0,0 +1,164 @@
+#include "csv.h"
+#include "exception.h"
+#include "source.h"
+#include <charconv>
+#include <cstring>
+
+static bool is_space(char ch) {
+  return ch == ' ' || ch == '\t' || ch == '\r';
+}
+
+// [begin, end) without the spaces around it
+static void trim(std::string_view text, std::size_t& begin, std::size_t& end) {
+  while(begin < end && is_space(text[begin])) begin++;
+  while(end > begin && is_space(text[end - 1])) end--;
+}
+
+// [begin, end) without the quotes around it, if it is quoted
+static void unquote(std::string_view text, std::size_t& begin, std::size_t& end) {
+  if(end - begin >= 2 && text[begin] == '"' && text[end - 1] == '"') {
+    begin++;
+    end--;
+  }
+}
+
+// end of the line starting at begin, the '\n' or the end of text
+static std::size_t line_end(std::string_view text, std::size_t begin) {
+  const void* newline = std::memchr(text.data() + begin, '\n', text.size() - begin);
+  return newline ? static_cast<const char*>(newline) - text.data() : text.size();
+}
+
+CsvReader::CsvReader(const std::shared_ptr<const SourceFile>& file)
+  : file(file), text(file->get_text()) {
+  if(text.empty()) return;
+
+  std::size_t end = line_end(text, 0);
+  std::size_t begin = 0;
+
+  for(;;) {
+    std::size_t comma = begin;
+    while(comma < end && text[comma] != ',') comma++;
+
+    std::size_t name_begin = begin, name_end = comma;
+    trim(text, name_begin, name_end);
+
+    // "name" is the same column as name
+    unquote(text, name_begin, name_end);
+
+    header.emplace_back(text.substr(name_begin, name_end - name_begin));
+    header_cells.push_back({ name_begin, name_end });
+
+    if(comma == end) break;
+    begin = comma + 1;
+  }
+
+  offset = std::min(end + 1, text.size());
+}
+
+std::shared_ptr<Exception> CsvReader::header_error(std::size_t field, const std::string& details) const {
+  const CsvChunk& cell = header_cells[field];
+  return std::make_shared<DataException>(file, cell.begin, cell.end, details);
+}
+
+CsvChunk CsvReader::next_chunk(std::size_t rows) {
+  std::size_t begin = offset;
+
+  for(std::size_t row = 0; row < rows && offset < text.size(); row++) {
+    offset = std::min(line_end(text, offset) + 1, text.size());
+  }
+
+  return { begin, offset };
+}
+
+std::int64_t CsvReader::line_of(const CsvChunk& chunk, std::size_t record) const {
+  std::size_t begin = chunk.begin;
+
+  for(;;) {
+    std::size_t end = std::min(line_end(text, begin), chunk.end);
+    std::size_t content_begin = begin, content_end = end;
+    trim(text, content_begin, content_end);
+
+    // blank lines are not records
+    if(content_begin != content_end && record-- == 0) break;
+    begin = end + 1;
+  }
+
+  return file->line_of(begin) + 1;
+}
+
+std::shared_ptr<Exception> CsvReader::parse(
+  const CsvChunk& chunk,
+  std::span<std::vector<double>* const> columns,
+  std::size_t& records
+) const {
+  records = 0;
+
+  auto error = [&](std::size_t begin, std::size_t end, const std::string& details) {
+    return std::make_shared<DataException>(file, begin, end, details);
+  };
+
+  for(std::size_t begin = chunk.begin; begin < chunk.end;) {
+    std::size_t end = std::min(line_end(text, begin), chunk.end);
+    std::size_t next = end + 1;
+
+    std::size_t content_begin = begin, content_end = end;
+    trim(text, content_begin, content_end);
+
+    if(content_begin == content_end) {
+      begin = next;
+      continue;
+    }
+
+    std::size_t field = 0;
+
+    for(std::size_t field_begin = begin;; field++) {
+      std::size_t field_end = field_begin;
+      while(field_end < end && text[field_end] != ',') field_end++;
+
+      if(field < columns.size() && columns[field]) {
+        std::size_t number_begin = field_begin, number_end = field_end;
+        trim(text, number_begin, number_end);
+
+        // "1.5" is the number 1.5, as "x" is the column x
+        unquote(text, number_begin, number_end);
+        trim(text, number_begin, number_end);
+
+        // from_chars takes no leading '+'
+        const char* first = text.data() + number_begin;
+        const char* last = text.data() + number_end;
+        if(first < last && *first == '+') first++;
+
+        double value;
+        auto [ptr, ec] = std::from_chars(first, last, value);
+
+        if(number_begin == number_end) {
+          return error(field_begin, field_end, std::string("empty field for '") + header[field] + "'");
+        }
+
+        if(ec != std::errc() || ptr != last) {
+          return error(
+            number_begin, number_end,
+            std::string("'") + std::string(text.substr(number_begin, number_end - number_begin)) + "' is not a number"
+          );
+        }
+
+        columns[field]->push_back(value);
+      }
+
+      if(field_end == end) break;
+      field_begin = field_end + 1;
+    }
+
+    if(field + 1 != header.size()) {
+      return error(
+        content_begin, content_end,
+        std::string("expected ") + std::to_string(header.size()) + " fields, got " + std::to_string(field + 1)
+      );
+    }
+
+    records++;
+    begin = next;
+  }
+
+  return nullptr;
+}
@@ -0,0 +1,64 @@
+#ifndef CSV
+#define CSV
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Exception;
+class SourceFile;
+
+// whole records of a csv file, as the byte range [begin, end)
+struct CsvChunk {
+  std::size_t begin = 0, end = 0;
+
+  inline bool empty() const { return begin == end; }
+};
+
+// numeric csv data: a header line naming the columns, then one record of
+// numbers per line. the file is mapped rather than read (see
+// SourceManager::add_file) and handed out in chunks of records that parse
+// independently, so memory is bounded by the chunk and not the file.
+// blank lines are skipped, a field may have spaces around its number.
+// a header name or a number may be quoted ("x", "1.5"), but a quoted field
+// cannot hold a comma: fields are split at every one
+class CsvReader {
+private:
+  std::shared_ptr<const SourceFile> file;
+  std::string_view text;
+  std::vector<std::string> header{};
+  // the byte range of each header name, without spaces and quotes
+  std::vector<CsvChunk> header_cells{};
+  // start of the first record not handed out yet
+  std::size_t offset = 0;
+
+public:
+  explicit CsvReader(const std::shared_ptr<const SourceFile>& file);
+
+  inline const std::vector<std::string>& get_header() const { return header; }
+
+  // a data error pointing at the header name of column field
+  std::shared_ptr<Exception> header_error(std::size_t field, const std::string& details) const;
+
+  // the next records, at most rows of them. empty once the file is done
+  CsvChunk next_chunk(std::size_t rows);
+
+  // line number (from 1) of record number record in chunk
+  std::int64_t line_of(const CsvChunk& chunk, std::size_t record) const;
+
+  // parses the records of chunk. field i of each record is appended to
+  // columns[i], fields whose column is nullptr are skipped unparsed.
+  // records counts the records read. returns the error of the first bad
+  // record, nullptr if there was none
+  std::shared_ptr<Exception> parse(
+    const CsvChunk& chunk,
+    std::span<std::vector<double>* const> columns,
+    std::size_t& records
+  ) const;
+};
+
+#endif
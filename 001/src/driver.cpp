@@ -0,0 +1,337 @@
+#include "driver.h"
+#include "csv.h"
+#include "program.h"
+#include "source.h"
+#include "batch/batch.h"
+#include "state/interpreter.h"
+#include "symbols.h"
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <unordered_set>
+#include <variant>
+
+// output buffer
+
+OutputBuffer::OutputBuffer(std::FILE* out): out(out) {
+  buffer.reserve(CAPACITY);
+}
+
+OutputBuffer::~OutputBuffer() {
+  flush();
+}
+
+void OutputBuffer::write(std::string_view text) {
+  if(buffer.size() + text.size() > CAPACITY) flush();
+  buffer.append(text);
+}
+
+void OutputBuffer::write_number(double value) {
+  char digits[32];
+  write(std::string_view(digits, format_number(digits, digits + sizeof(digits), value) - digits));
+}
+
+void OutputBuffer::write_value(const RTVariant& value) {
+  std::visit([&](const auto& val) -> void {
+    using T = std::decay_t<decltype(val)>;
+
+    if constexpr (std::is_same_v<T, std::string>) {
+      write(val);
+      write("\n");
+    } else if constexpr (std::is_same_v<T, Number>) {
+      write_number(val.get_value());
+      write("\n");
+    }
+  }, value);
+}
+
+void OutputBuffer::write_result(const RunType& result) {
+  const auto&[value, error] = result;
+
+  if(error) { // if theres an error print it as string
+    write(error->as_string());
+    write("\n");
+  } else if(value) {
+    write_value(value.value());
+  }
+}
+
+void OutputBuffer::flush() {
+  if(buffer.empty()) return;
+
+  std::fwrite(buffer.data(), 1, buffer.size(), out);
+  std::fflush(out);
+  buffer.clear();
+}
+
+// end output buffer
+
+std::shared_ptr<const SourceFile> load_script(const std::string& path) {
+  if(path != "-") return SourceManager::instance().add_file(path);
+
+  // pipes cannot be mapped, read them in large blocks instead
+  std::string text;
+  char block[1 << 16];
+  std::size_t read;
+
+  while((read = std::fread(block, 1, sizeof(block), stdin)) > 0) {
+    text.append(block, read);
+  }
+
+  if(std::ferror(stdin)) return nullptr;
+  return SourceManager::instance().add("<stdin>", std::move(text));
+}
+
+bool run_script(
+  const std::shared_ptr<const SourceFile>& source,
+  OutputBuffer& out,
+  RunOptions options
+) {
+  options.sink = [&](const RTVariant& value) {
+    out.write_value(value);
+  };
+
+  const auto&[value, error] = run(source, options);
+
+  if(error) {
+    out.write(error->as_string());
+    out.write("\n");
+  }
+
+  return !error;
+}
+
+// what one thread keeps from chunk to chunk of run_csv
+struct CsvWorker {
+  // per header field, only those the script reads are filled
+  std::vector<std::vector<double>> fields;
+  std::vector<std::vector<double>*> columns;
+  std::vector<double> values;
+  // row by row a record may have no value
+  std::vector<std::uint8_t> defined;
+  std::optional<Bindings> bindings;
+  // records evaluated before error
+  std::size_t done = 0;
+  std::shared_ptr<Exception> error;
+  // whether error came from the script rather than the data
+  bool runtime_error = false;
+};
+
+// the threads of run_csv, started once for the whole file. a round hands
+// index 0 to the calling thread and 1 up to count - 1 to one thread each,
+// and ends when every index has been processed
+class ChunkPool {
+private:
+  std::function<void(std::size_t)> task;
+  std::vector<std::thread> threads;
+
+  std::mutex mutex;
+  std::condition_variable started, finished;
+  std::size_t generation = 0;
+  std::size_t count = 0;
+  // indices of this round not finished yet
+  std::size_t pending = 0;
+  bool stopping = false;
+
+  void work(std::size_t index) {
+    std::size_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for(;;) {
+      started.wait(lock, [&]() { return stopping || generation != seen; });
+      if(stopping) return;
+
+      seen = generation;
+      if(index >= count) continue;
+
+      lock.unlock();
+      task(index);
+      lock.lock();
+
+      if(--pending == 0) finished.notify_one();
+    }
+  }
+
+public:
+  ChunkPool(std::size_t size, std::function<void(std::size_t)> task): task(std::move(task)) {
+    for(std::size_t index = 1; index < size; index++) {
+      threads.emplace_back(&ChunkPool::work, this, index);
+    }
+  }
+
+  ~ChunkPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+
+    started.notify_all();
+    for(std::thread& thread : threads) thread.join();
+  }
+
+  ChunkPool(const ChunkPool&) = delete;
+  ChunkPool& operator=(const ChunkPool&) = delete;
+
+  // count must not be more than the size the pool was made with
+  void run(std::size_t count) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      this->count = count;
+      pending = count - 1;
+      generation++;
+    }
+
+    if(count > 1) started.notify_all();
+    task(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&]() { return pending == 0; });
+  }
+};
+
+bool run_csv(
+  const std::shared_ptr<const SourceFile>& data,
+  const std::shared_ptr<const SourceFile>& script,
+  OutputBuffer& out,
+  const RunOptions& options,
+  unsigned threads
+) {
+  auto fail_with = [&](const std::shared_ptr<Exception>& error) {
+    out.write(error->as_string());
+    out.write("\n");
+    return false;
+  };
+
+  auto [program, error] = Program::compile(script, options.max_depth);
+  if(!program) return fail_with(error);
+
+  auto [batch, batch_error] = BatchProgram::compile(program);
+
+  // a script the kernels cannot run may assign variables the next record
+  // reads, so it goes row by row on one thread, in record order
+  if(!batch) threads = 1;
+
+  CsvReader reader(data);
+  const std::vector<std::string>& header = reader.get_header();
+
+  // the slot of each field, nullopt for those the script never reads.
+  // columns are bound by name, so a name no column can be bound to, or one
+  // two columns share, is an error in the data
+  std::vector<std::optional<std::uint32_t>> slots;
+  std::unordered_set<std::string_view> names;
+
+  for(std::size_t i = 0; i < header.size(); i++) {
+    const std::string& name = header[i];
+
+    std::optional<std::uint32_t> id = find_symbol(name);
+    if(id && is_builtin(*id)) {
+      return fail_with(reader.header_error(i, std::string("'") + name + "' is a builtin and cannot name a column"));
+    }
+
+    if(!names.insert(name).second) return fail_with(reader.header_error(i, std::string("duplicate column '") + name + "'"));
+
+    slots.push_back(program->slot_of(name));
+  }
+
+  std::vector<CsvWorker> workers(std::max(threads, 1u));
+
+  for(CsvWorker& worker : workers) {
+    worker.fields.resize(header.size());
+
+    for(std::size_t i = 0; i < header.size(); i++) {
+      worker.columns.push_back(slots[i] ? &worker.fields[i] : nullptr);
+    }
+  }
+
+  // evaluates records [0, count) row by row, up to the first error
+  auto evaluate_rows = [&](CsvWorker& worker, std::size_t count) {
+    if(!worker.bindings) worker.bindings.emplace(program->bind());
+
+    for(worker.done = 0; worker.done < count; worker.done++) {
+      for(std::size_t i = 0; i < header.size(); i++) {
+        if(slots[i]) worker.bindings->set(*slots[i], worker.fields[i][worker.done]);
+      }
+
+      RunType result = program->evaluate(*worker.bindings);
+      if(result.second) return result.second;
+
+      worker.defined[worker.done] = result.first.has_value();
+      if(result.first) worker.values[worker.done] = std::get<Number>(*result.first).get_value();
+    }
+
+    return std::shared_ptr<Exception>();
+  };
+
+  auto process = [&](CsvWorker& worker, const CsvChunk& chunk) {
+    for(std::vector<double>& field : worker.fields) field.clear();
+
+    std::size_t records;
+    std::shared_ptr<Exception> parse_error = reader.parse(chunk, worker.columns, records);
+
+    worker.values.resize(records);
+    worker.defined.assign(records, 1);
+    worker.error = nullptr;
+    worker.runtime_error = false;
+
+    if(batch) {
+      Columns columns(*program);
+
+      for(std::size_t i = 0; i < header.size(); i++) {
+        if(slots[i]) columns.set(*slots[i], worker.fields[i]);
+      }
+
+      worker.done = records;
+
+      // only the rows before a failing one are printed, and the batch does
+      // not say which row that was. errors are rare, the scalar program
+      // finds it
+      if(batch->evaluate(columns, worker.values)) worker.error = evaluate_rows(worker, records);
+    } else {
+      worker.error = evaluate_rows(worker, records);
+    }
+
+    worker.runtime_error = worker.error != nullptr;
+    if(!worker.error) worker.error = parse_error;
+  };
+
+  std::vector<CsvChunk> chunks;
+  ChunkPool pool(workers.size(), [&](std::size_t i) { process(workers[i], chunks[i]); });
+
+  for(;;) {
+    chunks.clear();
+
+    for(std::size_t i = 0; i < workers.size(); i++) {
+      CsvChunk chunk = reader.next_chunk(CSV_CHUNK_ROWS);
+      if(chunk.empty()) break;
+
+      chunks.push_back(chunk);
+    }
+
+    if(chunks.empty()) return true;
+
+    pool.run(chunks.size());
+
+    for(std::size_t i = 0; i < chunks.size(); i++) {
+      const CsvWorker& worker = workers[i];
+
+      for(std::size_t row = 0; row < worker.done; row++) {
+        if(worker.defined[row]) out.write_number(worker.values[row]);
+        out.write("\n");
+      }
+
+      if(worker.error) {
+        // the traceback points into the script, this says which record
+        if(worker.runtime_error) {
+          out.write(std::string("in record at ") + data->get_fn() + ", line ");
+          out.write(std::to_string(reader.line_of(chunks[i], worker.done)) + "\n");
+        }
+
+        return fail_with(worker.error);
+      }
+    }
+  }
+}
@@ -0,0 +1,62 @@
+#ifndef DRIVER
+#define DRIVER
+
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include "lexer.h"
+
+class SourceFile;
+
+// collects output and hands it to stdio in large chunks instead of
+// formatting and writing once per result
+class OutputBuffer {
+private:
+  std::FILE* out;
+  std::string buffer;
+
+public:
+  static constexpr std::size_t CAPACITY = 1 << 16;
+
+  OutputBuffer(std::FILE* out);
+  ~OutputBuffer();
+
+  void write(std::string_view text);
+  void write_number(double value);
+  void write_value(const RTVariant& value);
+  // prints a run() result the way the repl shows it
+  void write_result(const RunType& result);
+  void flush();
+};
+
+// maps a script file, "-" reads all of stdin. nullptr if it cannot be read
+std::shared_ptr<const SourceFile> load_script(const std::string& path);
+
+// runs a whole script printing the value of each top level statement,
+// returns false if it stopped on an error. options.sink is replaced
+bool run_script(
+  const std::shared_ptr<const SourceFile>& source,
+  OutputBuffer& out,
+  RunOptions options = {}
+);
+
+// records of csv data a worker parses and evaluates at a time
+constexpr std::size_t CSV_CHUNK_ROWS = 16384;
+
+// evaluates script once per record of the csv file data, with the columns
+// the header names bound as variables, and prints the value of each record
+// on a line of its own (an empty one if it has none). returns false if it
+// stopped on an error. with threads > 1 that many chunks are parsed and
+// evaluated at once. options.backend is not used, the script is compiled
+// (program.h) and runs in batches when it can (batch/batch.h)
+bool run_csv(
+  const std::shared_ptr<const SourceFile>& data,
+  const std::shared_ptr<const SourceFile>& script,
+  OutputBuffer& out,
+  const RunOptions& options = {},
+  unsigned threads = 1
+);
+
+#endif
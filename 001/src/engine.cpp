@@ -0,0 +1,104 @@
+#include "engine.h"
+#include "closure/closure_compiler.h"
+#include "folder.h"
+#include "parser.h"
+#include "resolver.h"
+#include "source.h"
+#include "stack_limit.h"
+#include "state/interpreter.h"
+#include "token_stream.h"
+#include "vm/compiler.h"
+#include "vm/vm.h"
+
+Engine::Engine()
+  : globals(std::make_shared<SymbolTable>()), context("<module>") {
+  define_builtins(*globals);
+  context.symbol_table = globals;
+}
+
+void Engine::reset() {
+  globals->clear();
+  define_builtins(*globals);
+}
+
+RunType Engine::run(
+  const std::string& fn,
+  const std::string& text,
+  const RunOptions& options
+) {
+  // the script is stored once; every position refers back to it by id
+  return run(SourceManager::instance().add(fn, text), options);
+}
+
+RunType Engine::run(
+  const std::shared_ptr<const SourceFile>& source,
+  const RunOptions& options
+) {
+  // error ids from an earlier run are not needed any more
+  ErrorTable::clear();
+
+  // nothing from the previous run points into the arena once it returned
+  arena.reset();
+
+  if(auto error = check_script_size(*source)) return { std::nullopt, error };
+
+  Lexer lexer(source);
+
+  TokenStream tokens(lexer);
+
+  // generate ast, the parser pulls tokens from the lexer as it goes.
+  // all nodes live in the arena until the next run. every pass after it
+  // recurses on this thread, so the depth is kept to what its stack can take
+  Parser parser(tokens, arena, stack_depth_limit(options.max_depth));
+  Result<ASTNode*> ast = parser.parse();
+
+  // a lexing error anywhere in the script wins over a syntax error, so lex
+  // the rest of the input before reporting one
+  if(!ast) tokens.drain();
+  if(tokens.get_error()) return { std::nullopt, ErrorTable::get(tokens.get_error()) };
+  if(!ast) return { std::nullopt, ast.get_error() };
+
+  // constants are computed once here rather than on every evaluation
+  ConstantFolder::fold(ast.value(), arena);
+
+  // variable nodes get their slots before either backend runs them
+  Resolver::resolve(ast.value(), *globals);
+
+  const StatementSink& sink = options.sink;
+  Interpreter interpreter;
+  Result<Value> result = Value::none();
+
+  if(options.backend == BACKEND_VM) {
+    Result<Chunk> chunk = Compiler::compile(ast.value());
+    if(!chunk) return { std::nullopt, chunk.get_error() };
+
+    result = VirtualMachine().run(chunk.value(), context, sink);
+  } else {
+    ClosureFrame frame{ context, *globals };
+
+    // the two ast backends, closures are compiled into the parse arena
+    auto evaluate = [&](ASTNode* node) -> Result<Value> {
+      if(options.backend == BACKEND_CLOSURE) return ClosureCompiler::compile(node, arena)(frame);
+      return interpreter.visit(node, context);
+    };
+
+    if(!sink) {
+      result = evaluate(ast.value());
+    } else {
+      // one statement at a time so each value can be handed out as it completes
+      for(ASTNode* statement : static_cast<StatementsNode*>(ast.value())->statements) {
+        result = evaluate(statement);
+        if(!result) break;
+        if(!result->is_none()) sink(Number(result->as_number()));
+      }
+    }
+  }
+
+  if(!result) {
+    return { std::nullopt, result.get_error() };
+  } else if(result->is_none()) {
+    return { std::nullopt, nullptr };
+  }
+
+  return { Number(result->as_number()), nullptr };
+}
@@ -0,0 +1,49 @@
+#ifndef ENGINE
+#define ENGINE
+
+#include <memory>
+#include <string>
+#include "arena.h"
+#include "context.h"
+#include "lexer.h"
+#include "state/symbol_table.h"
+
+class SourceFile;
+
+// one interpreter instance: the globals scripts run against, with the
+// builtins set once when it is made, and the parse arena reused from run
+// to run. variables persist across runs of the same engine. an engine is
+// never shared, threads run scripts concurrently by owning one each
+class Engine {
+private:
+  std::shared_ptr<SymbolTable> globals;
+  Context context;
+  AstArena arena;
+
+public:
+  Engine();
+
+  Engine(const Engine&) = delete;
+  Engine& operator=(const Engine&) = delete;
+
+  RunType run(
+    const std::string& fn,
+    const std::string& text,
+    const RunOptions& options = {}
+  );
+
+  // lexing, parsing and evaluation happen once for the whole program, the
+  // result is the value of its last statement
+  RunType run(
+    const std::shared_ptr<const SourceFile>& source,
+    const RunOptions& options = {}
+  );
+
+  // forgets every variable scripts defined and the slots they took, the
+  // builtins are set again
+  void reset();
+
+  inline SymbolTable& get_globals() { return *globals; }
+};
+
+#endif
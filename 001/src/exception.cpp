@@ -1,5 +1,6 @@
 #include "exception.h"
-#include <iostream>
+#include "source.h"
+#include <algorithm>
 
 Exception::Exception(
   const Position& pos_start,
@@ -7,16 +8,16 @@ Exception::Exception(
   const std::string& message,
   const std::string& details
 )
-  : pos_start(pos_start), pos_end(pos_end), message(message), details(details) {}
+  : pos_start(pos_start), pos_end(pos_end), message(message), details(details),
+    source(SourceManager::instance().get(pos_start.get_file())) {}
 
 std::string Exception::as_string() const {
   std::string result = message + ": " + details;
-  result += "\nFile " + pos_start.get_fn() + ", line " + std::to_string(pos_start.get_ln() + 1);
-  result += "\n\n" + string_with_arrows(
-    pos_start.get_ftxt(),
-    pos_start,
-    pos_end
-  );
+  if(!source) return result;
+
+  result += std::string("\nFile ") + source->get_fn() + ", line "
+          + std::to_string(source->line_of(pos_start.get_idx()) + 1);
+  result += std::string("\n\n") + string_with_arrows(*source, pos_start, pos_end);
   return result;
 }
 
@@ -25,7 +26,14 @@ IllegalCharException::IllegalCharException(
   const Position& pos_end,
   char ch
 )
-  : Exception(pos_start, pos_end, "Illegal Character", "'" + std::string(1, ch) + "'") {}
+  : Exception(pos_start, pos_end, "Illegal Character", std::string("'") + ch + "'") {}
+
+IllegalNumberException::IllegalNumberException(
+  const Position& pos_start,
+  const Position& pos_end,
+  const std::string& details
+)
+  : Exception(pos_start, pos_end, "Illegal Number", details) {}
 
 InvalidSyntaxException::InvalidSyntaxException(
   const Position& pos_start,
@@ -46,11 +54,9 @@ RTException::RTException(
 std::string RTException::as_string() const {
   std::string result = generate_traceback();
   result += this->message + ": " + this->details;
-  result += "\n\n" + string_with_arrows(
-    pos_start.get_ftxt(),
-    pos_start,
-    pos_end
-  );
+  if(!source) return result;
+
+  result += std::string("\n\n") + string_with_arrows(*source, pos_start, pos_end);
 
   return result;
 }
@@ -62,7 +68,7 @@ std::string RTException::generate_traceback() const {
   std::optional<Context> ctx = this->context;
 
   while(ctx) {
-    result = "  File " + pos.get_fn() + ", line " + std::to_string(pos.get_ln() + 1)
+    result = std::string("  File ") + pos.get_fn() + ", line " + std::to_string(pos.get_ln() + 1)
            +  ", in " + ctx->display_name + "\n" + result;
 
     if(!ctx->parent.has_value() || !ctx->parent.value()) break;
@@ -72,7 +78,26 @@ std::string RTException::generate_traceback() const {
     ctx = *ctx->parent.value();
   }
 
-  return "traceback (most recent call last):\n" + result;
+  return std::string("traceback (most recent call last):\n") + result;
+}
+
+DataException::DataException(
+  const std::shared_ptr<const SourceFile>& file,
+  std::int64_t begin,
+  std::int64_t end,
+  const std::string& details
+)
+  : Exception(Position(), Position(), "Data Error", details), begin(begin), end(end) {
+  source = file;
+}
+
+std::string DataException::as_string() const {
+  std::string result = message + ": " + details;
+  if(!source) return result;
+
+  result += std::string("\nFile ") + source->get_fn() + ", line " + std::to_string(source->line_of(begin) + 1);
+  result += std::string("\n\n") + string_with_arrows(*source, begin, end);
+  return result;
 }
 
 ExpectedCharException::ExpectedCharException(
@@ -82,44 +107,61 @@ ExpectedCharException::ExpectedCharException(
 ): Exception(pos_start, pos_end, "Expected Character", details) {}
 
 std::string string_with_arrows(
-  const std::string& text,
+  const SourceFile& source,
   const Position& pos_start,
   const Position& pos_end
+) {
+  return string_with_arrows(source, pos_start.get_idx(), pos_end.get_idx());
+}
+
+std::string string_with_arrows(
+  const SourceFile& source,
+  std::int64_t begin,
+  std::int64_t end
 ) {
   std::string result; // keep result as string
+  std::string_view text = source.get_text();
+
+  // an end position is exclusive, so the last character it covers is the one
+  // before it. this keeps a token that ends on a newline on its own line
+  std::int64_t idx_last = std::max(begin, end - 1);
 
   // find last occurence of newline
   // from current index of position minus one all the way to the left
-  size_t idx_start_temp = text.rfind('\n', pos_start.get_idx() - 1);
+  // (nothing to search when the error is at the very start of the text)
+  size_t idx_start_temp = (begin == 0)
+    ? std::string::npos
+    : text.rfind('\n', begin - 1);
   // set index start to be 0 if idx_start_temp was an npos (meaning that \n wasnt found)
-  // otherwise, set it to the first occurence of \n which is idx_start_temp
-  size_t idx_start = (idx_start_temp == std::string::npos) ? 0 : idx_start_temp;
-  // find first occurence of newline starting from the start of the index plus one
-  size_t idx_end = text.find('\n', idx_start + 1);
+  // otherwise, the line starts right after that \n
+  size_t idx_start = (idx_start_temp == std::string::npos) ? 0 : idx_start_temp + 1;
+  // find first occurence of newline starting from the start of the line
+  size_t idx_end = text.find('\n', idx_start);
   // if end is an npos, i.e the substring was not found, then the index end will just be
   // the length of the text
   if (idx_end == std::string::npos) idx_end = text.length();
 
   // determines how many lines the error spans
-  int line_count = pos_end.get_ln() - pos_start.get_ln() + 1;
+  std::int64_t line_count = source.line_of(idx_last) - source.line_of(begin) + 1;
 
   // loop through the affected lines
-  for (int i = 0; i < line_count; i++) {
+  for (std::int64_t i = 0; i < line_count; i++) {
     // extracts current line using idx_start and idx_end
-    std::string line = text.substr(idx_start, idx_end - idx_start);
-    
-    // on the first line, it uses pos_start.get_col()
+    std::string line(text.substr(idx_start, idx_end - idx_start));
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+
+    // on the first line, it uses the column of begin
     // for lines that are not the first line, it starts at 0
-    int col_start = (i == 0) ? pos_start.get_col() : 0;
+    std::int64_t col_start = (i == 0) ? source.col_of(begin) : 0;
 
-    // on last line, it is pos_end.get_col()
+    // on last line, it is one past the column of the last covered character
     // otherwise, this will span the entire line
-    int col_end = (i == line_count - 1) ? pos_end.get_col() : line.length() - 1;
+    std::int64_t col_end = (i == line_count - 1) ? source.col_of(idx_last) + 1 : (std::int64_t)line.length() - 1;
 
     // bounds checking
     // this just ensures col end is within line length
-    if (col_end < 0 || col_end > (int)line.length()) {
-      col_end = line.length() - 1;
+    if (col_end < 0 || col_end > (std::int64_t)line.length()) {
+      col_end = (std::int64_t)line.length() - 1;
     }
 
     // if column start is greater than column end, clamp column start to column end
@@ -127,19 +169,25 @@ std::string string_with_arrows(
       col_start = col_end;
     }
 
+    // an empty line leaves col_end at -1, the caret then goes in column 0
+    if (col_start < 0) {
+      col_start = 0;
+    }
+
     // build output string
     // appends line of code followed by newline
+    if (i > 0) result += '\n';
     result += line + '\n';
     // adds carets under problematic range
     // spaces pad up to col_start, caret spans from col_start to col_end
-    result += std::string(col_start, ' ') + std::string(std::max(1, col_end - col_start), '^');
+    result += std::string(col_start, ' ') + std::string(std::max<std::int64_t>(1, col_end - col_start), '^');
 
     // updat line indices
-    // moves idx_start to idx_end which is next line
+    // moves idx_start past idx_end which is next line
     // finds next newline/end of text
-    idx_start = idx_end;
+    idx_start = idx_end + 1;
     if (idx_start < text.length()) {
-      idx_end = text.find('\n', idx_start + 1);
+      idx_end = text.find('\n', idx_start);
       if (idx_end == std::string::npos) idx_end = text.length();
     }
   }
@@ -1,16 +1,22 @@
 #ifndef EXCEPTION
 #define EXCEPTION
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include "context.h"
 #include "position.h"
 
+class SourceFile;
+
 class Exception {
 protected:
   Position pos_start, pos_end;
   std::string message, details;
-  
+  // keeps the script alive so the error can still be printed after run() returns
+  std::shared_ptr<const SourceFile> source;
+
 public:
   Exception(
     const Position& pos_start,
@@ -31,6 +37,15 @@ public:
   );
 };
 
+class IllegalNumberException : public Exception {
+public:
+  IllegalNumberException(
+    const Position& pos_start,
+    const Position& pos_end,
+    const std::string& details
+  );
+};
+
 class InvalidSyntaxException : public Exception {
 public:
   InvalidSyntaxException(
@@ -56,6 +71,23 @@ public:
   std::string generate_traceback() const;
 };
 
+// a bad record in a data file (csv.h). data files may be larger than a
+// Position can point into, so the record is kept as 64 bit offsets
+class DataException : public Exception {
+private:
+  std::int64_t begin, end;
+
+public:
+  DataException(
+    const std::shared_ptr<const SourceFile>& file,
+    std::int64_t begin,
+    std::int64_t end,
+    const std::string& details
+  );
+
+  std::string as_string() const override;
+};
+
 class ExpectedCharException : public Exception {
 public:
   ExpectedCharException(
@@ -66,9 +98,16 @@ public:
 };
 
 std::string string_with_arrows(
-  const std::string& text,
+  const SourceFile& source,
   const Position& pos_start,
   const Position& pos_end
 );
 
+// the same for the bytes [begin, end) of source
+std::string string_with_arrows(
+  const SourceFile& source,
+  std::int64_t begin,
+  std::int64_t end
+);
+
 #endif
\ No newline at end of file
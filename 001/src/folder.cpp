@@ -0,0 +1,232 @@
+#include "folder.h"
+#include "state/interpreter.h"
+#include <bit>
+#include <cstdint>
+
+static std::size_t count_nodes(const ASTNode* node) {
+  switch(node->kind) {
+    case NODE_NUMBER:
+    case NODE_VAR_ACCESS: return 1;
+    case NODE_VAR_ASSIGN: return 1 + count_nodes(static_cast<const VarAssignNode*>(node)->value_node);
+    case NODE_BIN_OP: {
+      auto* bin_op = static_cast<const BinOpNode*>(node);
+      return 1 + count_nodes(bin_op->left_node) + count_nodes(bin_op->right_node);
+    }
+    case NODE_UNARY_OP: return 1 + count_nodes(static_cast<const UnaryOpNode*>(node)->node);
+    case NODE_IF: {
+      auto* if_node = static_cast<const IfNode*>(node);
+      std::size_t count = 1;
+      for(const auto&[condition, expr] : if_node->cases) count += count_nodes(condition) + count_nodes(expr);
+      if(if_node->else_case) count += count_nodes(if_node->else_case);
+      return count;
+    }
+    case NODE_FOR: {
+      auto* for_node = static_cast<const ForNode*>(node);
+      std::size_t count = 1 + count_nodes(for_node->start_value) + count_nodes(for_node->end_value);
+      if(for_node->step_value) count += count_nodes(for_node->step_value);
+      return count + count_nodes(for_node->body);
+    }
+    case NODE_WHILE: {
+      auto* while_node = static_cast<const WhileNode*>(node);
+      return 1 + count_nodes(while_node->condition) + count_nodes(while_node->body);
+    }
+    case NODE_STATEMENTS: break;
+  }
+
+  std::size_t count = 1;
+  for(const ASTNode* statement : static_cast<const StatementsNode*>(node)->statements) {
+    count += count_nodes(statement);
+  }
+  return count;
+}
+
+static double apply(BinaryOp op, double left, double right) {
+  switch(op) {
+    case BIN_ADD: return apply_binary<BIN_ADD>(left, right);
+    case BIN_SUB: return apply_binary<BIN_SUB>(left, right);
+    case BIN_MUL: return apply_binary<BIN_MUL>(left, right);
+    case BIN_DIV: return apply_binary<BIN_DIV>(left, right);
+    case BIN_POW: return apply_binary<BIN_POW>(left, right);
+    case BIN_MOD: return apply_binary<BIN_MOD>(left, right);
+    case BIN_EE:  return apply_binary<BIN_EE>(left, right);
+    case BIN_NE:  return apply_binary<BIN_NE>(left, right);
+    case BIN_LT:  return apply_binary<BIN_LT>(left, right);
+    case BIN_GT:  return apply_binary<BIN_GT>(left, right);
+    case BIN_LTE: return apply_binary<BIN_LTE>(left, right);
+    case BIN_GTE: return apply_binary<BIN_GTE>(left, right);
+    case BIN_AND: return apply_binary<BIN_AND>(left, right);
+    case BIN_OR:  break;
+  }
+
+  return apply_binary<BIN_OR>(left, right);
+}
+
+// compares bits, so that -0 is not taken for 0
+static bool is_number(const ASTNode* node, double value) {
+  return node->kind == NODE_NUMBER &&
+    std::bit_cast<std::uint64_t>(static_cast<const NumberNode*>(node)->value) == std::bit_cast<std::uint64_t>(value);
+}
+
+FoldStats ConstantFolder::fold(ASTNode* program, AstArena& arena) {
+  ConstantFolder folder(arena);
+  std::size_t before = count_nodes(program);
+
+  for(ASTNode*& statement : static_cast<StatementsNode*>(program)->statements) {
+    statement = folder.fold(statement, false);
+  }
+
+  folder.stats.eliminated = before - count_nodes(program);
+  return folder.stats;
+}
+
+ASTNode* ConstantFolder::fold(ASTNode* node, bool blamed) {
+  switch(node->kind) {
+    case NODE_NUMBER:
+    case NODE_VAR_ACCESS: break;
+
+    case NODE_VAR_ASSIGN: {
+      // an assignment passes the blame on to its value
+      auto* assign = static_cast<VarAssignNode*>(node);
+      assign->value_node = fold(assign->value_node, blamed);
+      break;
+    }
+
+    case NODE_BIN_OP: return fold_bin_op(static_cast<BinOpNode*>(node), blamed);
+    case NODE_UNARY_OP: return fold_unary_op(static_cast<UnaryOpNode*>(node), blamed);
+    case NODE_IF: return fold_if(static_cast<IfNode*>(node), blamed);
+
+    case NODE_FOR: {
+      auto* for_node = static_cast<ForNode*>(node);
+      for_node->start_value = fold(for_node->start_value, false);
+      for_node->end_value = fold(for_node->end_value, false);
+      if(for_node->step_value) for_node->step_value = fold(for_node->step_value, false);
+      for_node->body = fold(for_node->body, false);
+      break;
+    }
+
+    case NODE_WHILE: {
+      auto* while_node = static_cast<WhileNode*>(node);
+      while_node->condition = fold(while_node->condition, false);
+      while_node->body = fold(while_node->body, false);
+      break;
+    }
+
+    case NODE_STATEMENTS:
+      for(ASTNode*& statement : static_cast<StatementsNode*>(node)->statements) {
+        statement = fold(statement, false);
+      }
+      break;
+  }
+
+  return node;
+}
+
+ASTNode* ConstantFolder::fold_bin_op(BinOpNode* node, bool blamed) {
+  bool divides = node->op == BIN_DIV || node->op == BIN_MOD;
+
+  node->left_node = fold(node->left_node, false);
+  node->right_node = fold(node->right_node, divides);
+
+  ASTNode* left = node->left_node;
+  ASTNode* right = node->right_node;
+
+  if(left->kind == NODE_NUMBER && right->kind == NODE_NUMBER) {
+    double left_value = static_cast<NumberNode*>(left)->value;
+    double right_value = static_cast<NumberNode*>(right)->value;
+
+    // must still fail when it runs
+    if(divides && right_value == 0) return node;
+
+    stats.folded++;
+    return arena.make<NumberNode>(
+      apply(node->op, left_value, right_value), node->get_pos_start(), node->get_pos_end()
+    );
+  }
+
+  // a constant left side of and/or that decides the result alone, the
+  // right side would never run
+  bool logic = node->op == BIN_AND || node->op == BIN_OR;
+
+  if(logic && left->kind == NODE_NUMBER) {
+    bool truth = static_cast<NumberNode*>(left)->value != 0;
+
+    if(truth == (node->op == BIN_OR)) {
+      stats.folded++;
+      return arena.make<NumberNode>(truth ? 1 : 0, node->get_pos_start(), node->get_pos_end());
+    }
+  }
+
+  if(blamed) return node;
+
+  // exact for every double, as long as x is never "no value" (-1)
+  bool keep_left =
+    (is_number(right, 1) && (node->op == BIN_MUL || node->op == BIN_DIV || node->op == BIN_POW)) ||
+    (is_number(right, 0) && node->op == BIN_SUB);
+  bool keep_right = is_number(left, 1) && node->op == BIN_MUL;
+
+  if(keep_left && !may_be_undefined(left)) {
+    stats.simplified++;
+    return left;
+  }
+
+  if(keep_right && !may_be_undefined(right)) {
+    stats.simplified++;
+    return right;
+  }
+
+  return node;
+}
+
+ASTNode* ConstantFolder::fold_unary_op(UnaryOpNode* node, bool blamed) {
+  node->node = fold(node->node, false);
+
+  if(node->node->kind == NODE_NUMBER) {
+    double value = static_cast<NumberNode*>(node->node)->value;
+
+    switch(node->op) {
+      case UN_MINUS: value = apply_unary<UN_MINUS>(value); break;
+      case UN_NOT: value = apply_unary<UN_NOT>(value); break;
+      case UN_PLUS: value = apply_unary<UN_PLUS>(value); break;
+    }
+
+    stats.folded++;
+    return arena.make<NumberNode>(value, node->get_pos_start(), node->get_pos_end());
+  }
+
+  if(node->op == UN_PLUS && !blamed && !may_be_undefined(node->node)) {
+    stats.simplified++;
+    return node->node;
+  }
+
+  return node;
+}
+
+ASTNode* ConstantFolder::fold_if(IfNode* node, bool blamed) {
+  // a division by an if blames the branch that ran, so branches keep the blame
+  for(auto&[condition, expr] : node->cases) {
+    condition = fold(condition, false);
+    expr = fold(expr, blamed);
+  }
+
+  if(node->else_case) node->else_case = fold(node->else_case, blamed);
+
+  // the branch that will run, as long as every condition before it is constant
+  ASTNode* taken = node->else_case;
+
+  for(const auto&[condition, expr] : node->cases) {
+    if(condition->kind != NODE_NUMBER) return node;
+
+    if(static_cast<NumberNode*>(condition)->value != 0) {
+      taken = expr;
+      break;
+    }
+  }
+
+  // a number branch is the value and the blame of the if at the same time
+  if(taken && taken->kind == NODE_NUMBER) {
+    stats.folded++;
+    return taken;
+  }
+
+  return node;
+}
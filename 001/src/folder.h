@@ -0,0 +1,40 @@
+#ifndef FOLDER
+#define FOLDER
+
+#include <cstddef>
+#include "arena.h"
+#include "nodes.h"
+
+// what a fold pass did to a program
+struct FoldStats {
+  std::size_t folded = 0;      // subtrees replaced by the constant they compute
+  std::size_t simplified = 0;  // operations dropped by an identity
+  std::size_t eliminated = 0;  // nodes the program has fewer of
+};
+
+// runs once between parsing and evaluation. constant operations, and/or
+// with a constant left side that decides them and ifs with constant
+// conditions become numbers, and x*1, 1*x, x/1, x^1 and x-0 become x when x
+// always has a value. a division or modulus by a constant
+// zero is left in place so it still fails at runtime, and no expression
+// an error could be blamed on changes its range
+class ConstantFolder {
+private:
+  AstArena& arena;
+  FoldStats stats{};
+
+  ConstantFolder(AstArena& arena): arena(arena) {}
+
+  // blamed is set where node's range would be reported for a division by
+  // zero, there it may only be replaced by a number over the same range
+  ASTNode* fold(ASTNode* node, bool blamed);
+  ASTNode* fold_bin_op(BinOpNode* node, bool blamed);
+  ASTNode* fold_unary_op(UnaryOpNode* node, bool blamed);
+  ASTNode* fold_if(IfNode* node, bool blamed);
+
+public:
+  // folds the statements of program in place, new nodes go into arena
+  static FoldStats fold(ASTNode* program, AstArena& arena);
+};
+
+#endif
@@ -1,86 +1,90 @@
 #include "lexer.h"
-#include "context.h"
+#include "engine.h"
 #include "exception.h"
-#include "parser.h"
 #include "position.h"
-#include "state/interpreter.h"
-#include "state/symbol_table.h"
-#include <algorithm>
+#include "source.h"
+#include "symbols.h"
+#include <charconv>
 
-Lexer::Lexer(const std::string& fn, const std::string& text): fn(fn), text(text) {
+Lexer::Lexer(const std::shared_ptr<const SourceFile>& source)
+  : source(source), text(source->get_text()), pos(-1, source->get_id()) {
   advance();
 }
 
 void Lexer::advance() {
-  pos.advance(cur_char);
+  pos.advance();
   cur_char = (pos.get_idx() < (int)text.size()) ? text[pos.get_idx()] : '\0';
 }
 
-VectorPair Lexer::make_tokens() {
-  std::vector<Token> tokens{};
-
-    while(cur_char != '\0') {
-      if(cur_char == '\t' || cur_char == ' ') {
-        advance();
-      } else if(cur_char == '+') {
-        tokens.emplace_back(PLS_T, std::nullopt, pos);
-        advance();
-      } else if(cur_char == '-') {
-        tokens.emplace_back(MIN_T, std::nullopt, pos);
-        advance();
-      } else if(cur_char == '*') {
-        tokens.emplace_back(MUL_T, std::nullopt, pos);
-        advance();
-      } else if(cur_char == '/') {
-        tokens.emplace_back(DIV_T, std::nullopt, pos);
-        advance();
-      } else if (cur_char == '^') {
-        tokens.emplace_back(POW_T, std::nullopt, pos);
-        advance();
-      } else if(cur_char == '%') {
-        tokens.emplace_back(MOD_T, std::nullopt, pos);
-        advance();
-      } else if(cur_char == '(') {
-        tokens.emplace_back(LPR_T, std::nullopt, pos);
-        advance();
-      } else if(cur_char == ')') {
-        tokens.emplace_back(RPR_T, std::nullopt, pos);
-        advance();
-      } else if(cur_char == '!') {
-        const auto&[tok, error] = make_not_equals();
-        if(error) return { {}, error };
-        tokens.emplace_back(tok.value());
-      } else if(cur_char == '=') {
-        tokens.emplace_back(make_equals());
-      } else if(cur_char == '<') {
-        tokens.emplace_back(make_lt());
-      } else if(cur_char == '>') {
-        tokens.emplace_back(make_gt());
-      } else if((std::isdigit(cur_char) || cur_char == '.') && cur_char != '.') {
-        tokens.emplace_back(make_number());
-      } else if((std::isalnum(cur_char) || cur_char == '_')) {
-        tokens.emplace_back(make_identifier());
-      } else {
-        Position pos_start = pos.copy();
-        char ch = cur_char;
-        advance();
-        return {
-          {},
-          std::make_shared<IllegalCharException>(pos_start, pos, ch)
-        };
-      }
-    }
+std::shared_ptr<Exception> check_script_size(const SourceFile& source) {
+  if(source.get_text().size() <= MAX_SCRIPT_SIZE) return nullptr;
 
-    tokens.emplace_back(EOF_T, std::nullopt, pos);
-    return { tokens, nullptr };
+  // without a file the error does not print the script, which may be huge
+  return std::make_shared<Exception>(
+    Position(), Position(), "Script Error",
+    std::string("scripts are limited to ") + std::to_string(MAX_SCRIPT_SIZE) + " bytes"
+  );
 }
 
-bool Lexer::in_keywords(const std::string& text) {
-  return std::find(KEYWORDS.cbegin(), KEYWORDS.cend(), text) != KEYWORDS.cend();
+Result<Token> Lexer::next_token() {
+  while(cur_char == '\t' || cur_char == ' ' || cur_char == '\r') {
+    advance();
+  }
+
+  if(cur_char == '\0') return Token(EOF_T, pos);
+
+  Token tok;
+
+  if(cur_char == '\n' || cur_char == ';') {
+    tok = Token(NEWL_T, pos);
+    advance();
+  } else if(cur_char == '+') {
+    tok = Token(PLS_T, pos);
+    advance();
+  } else if(cur_char == '-') {
+    tok = Token(MIN_T, pos);
+    advance();
+  } else if(cur_char == '*') {
+    tok = Token(MUL_T, pos);
+    advance();
+  } else if(cur_char == '/') {
+    tok = Token(DIV_T, pos);
+    advance();
+  } else if (cur_char == '^') {
+    tok = Token(POW_T, pos);
+    advance();
+  } else if(cur_char == '%') {
+    tok = Token(MOD_T, pos);
+    advance();
+  } else if(cur_char == '(') {
+    tok = Token(LPR_T, pos);
+    advance();
+  } else if(cur_char == ')') {
+    tok = Token(RPR_T, pos);
+    advance();
+  } else if(cur_char == '!') {
+    return make_not_equals();
+  } else if(cur_char == '=') {
+    tok = make_equals();
+  } else if(cur_char == '<') {
+    tok = make_lt();
+  } else if(cur_char == '>') {
+    tok = make_gt();
+  } else if((std::isdigit(cur_char) || cur_char == '.') && cur_char != '.') {
+    return make_number();
+  } else if((std::isalnum(cur_char) || cur_char == '_')) {
+    tok = make_identifier();
+  } else {
+    Position pos_start = pos.copy();
+    char ch = cur_char;
+    advance();
+    return fail(std::make_shared<IllegalCharException>(pos_start, pos, ch));
+  }
+
+  return tok;
 }
 
-Token Lexer::make_number() {
-  std::string num_str = "";
+Result<Token> Lexer::make_number() {
   int dot_count = 0;
   Position pos_start = pos.copy();
 
@@ -88,56 +92,65 @@ Token Lexer::make_number() {
     if(cur_char == '.') {
       if(dot_count == 1) break;
       dot_count++;
-
-      num_str += '.';
-    } else {
-      num_str += cur_char;
     }
 
     advance();
   }
 
-  return Token(
-    dot_count == 0 ? INT_T : FLT_T,
-    dot_count == 0 ? std::stoi(num_str) : std::stof(num_str),
-    pos_start,
-    pos
-  );
+  // convert straight from the source buffer, no temporary string
+  Token tok(dot_count == 0 ? INT_T : FLT_T, pos_start, pos);
+  const char* first = text.data() + pos_start.get_idx();
+  const char* last = text.data() + pos.get_idx();
+  std::from_chars_result parsed = std::from_chars(first, last, tok.number);
+
+  if(parsed.ec == std::errc::result_out_of_range) {
+    // too small for a double is 0, too large is an error: a nonzero digit
+    // before the '.' means the value is at least 1
+    const char* digit = first;
+    while(digit < last && *digit == '0') digit++;
+
+    if(digit < last && *digit != '.') {
+      return fail(std::make_shared<IllegalNumberException>(pos_start, pos, "number literal too large"));
+    }
+
+    tok.number = 0;
+  }
+
+  return tok;
 }
 
 Token Lexer::make_identifier() {
-  std::string id_str = "";
   Position pos_start = pos.copy();
 
   while(cur_char != '\0' && (std::isalnum(cur_char) || cur_char == '_')) {
-    id_str += cur_char;
     advance();
   }
 
-  std::string type = ( in_keywords(id_str) ) ? KWD_T : ID_T;
+  std::string_view id_str = text.substr(pos_start.get_idx(), pos.get_idx() - pos_start.get_idx());
+  Keyword keyword = keyword_lookup(id_str);
+
+  Token tok(keyword != KW_NONE ? KWD_T : ID_T, pos_start, pos);
+  tok.id = (keyword != KW_NONE) ? static_cast<std::uint32_t>(keyword) : intern(id_str);
 
-  return Token(type, id_str, pos_start, pos);
+  return tok;
 }
 
-TokenPair Lexer::make_not_equals() {
+Result<Token> Lexer::make_not_equals() {
   Position pos_start = pos.copy();
   advance();
 
   if(cur_char == '=') {
     advance();
-    return { Token(NE_T, std::nullopt, pos_start, pos), nullptr };
+    return Token(NE_T, pos_start, pos);
   }
 
   advance();
-  return { 
-    std::nullopt,
-    std::make_shared<ExpectedCharException>(pos_start, pos, "'=' expected (after '!')") 
-  };
+  return fail(std::make_shared<ExpectedCharException>(pos_start, pos, "'=' expected (after '!')"));
 }
 
 Token Lexer::make_equals() {
   Position pos_start = pos.copy();
-  std::string tok_type = EQU_T;
+  TokenKind tok_type = EQU_T;
   advance();
 
   if(cur_char == '=') {
@@ -145,11 +158,11 @@ Token Lexer::make_equals() {
     tok_type = EE_T;
   }
 
-  return Token(tok_type, std::nullopt, pos_start, pos);
+  return Token(tok_type, pos_start, pos);
 }
 
 Token Lexer::make_lt() {
-  std::string tok_type = LT_T;
+  TokenKind tok_type = LT_T;
   Position pos_start = pos.copy();
   advance();
 
@@ -158,11 +171,11 @@ Token Lexer::make_lt() {
     tok_type = LTE_T;
   }
 
-  return Token(tok_type, std::nullopt, pos_start, pos);
+  return Token(tok_type, pos_start, pos);
 }
 
 Token Lexer::make_gt() {
-  std::string tok_type = GT_T;
+  TokenKind tok_type = GT_T;
   Position pos_start = pos.copy();
   advance();
 
@@ -171,43 +184,23 @@ Token Lexer::make_gt() {
     tok_type = GTE_T;
   }
 
-  return Token(tok_type, std::nullopt, pos_start, pos);
+  return Token(tok_type, pos_start, pos);
 }
 
-std::shared_ptr<SymbolTable> global = std::make_shared<SymbolTable>();
-
 RunType run(
   const std::string& fn,
-  const std::string& text
+  const std::string& text,
+  const RunOptions& options
 ) {
+  // the script is stored once; every position refers back to it by id
+  return run(SourceManager::instance().add(fn, text), options);
+}
 
-  //built in variables
-  global->set("null", -1);
-  global->set("quit", 0);
-  global->set("true", 1);
-  global->set("false", 0);
-
-  Lexer lexer(fn, text);
-
-  const auto&[tokens, error] = lexer.make_tokens();
-  if(error) return { std::nullopt, error };
-
-  // generate ast
-  Parser parser(tokens);
-  ParseResult ast = parser.parse();
-  if(ast.error) return { std::nullopt, ast.error };
-
-  Context context("<module>");
-  context.symbol_table = global;
-
-  Interpreter interpreter;
-  RTResult result = interpreter.visit(ast.node, context);
-
-  if(result.error) {
-    return { std::nullopt, result.error };
-  } else if(!result.value && !result.error) {
-    return { std::nullopt, nullptr };
-  }
-
-  return { result.value.value(), nullptr };
-}
\ No newline at end of file
+RunType run(
+  const std::shared_ptr<const SourceFile>& source,
+  const RunOptions& options
+) {
+  // variables persist between calls on the same thread, like a repl session
+  thread_local Engine engine;
+  return engine.run(source, options);
+}
@@ -1,7 +1,11 @@
 #ifndef LEXER
 #define LEXER
 
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <utility>
 #include "exception.h"
@@ -9,74 +13,67 @@
 #include "state/symbol_table.h"
 #include "token.h"
 #include "position.h"
+#include "result.h"
 #include "parser.h"
 
-const std::string PLS_T = "plus",
-                  MIN_T = "minus",
-                  DIV_T = "divide",
-                  MUL_T = "multiply",
-                  ID_T  = "identifier",
-                  KWD_T = "keyword",
-                  LPR_T = "lparen",
-                  RPR_T = "rparen",
-                  INT_T = "int",
-                  FLT_T = "float",
-                  EOF_T = "eof",
-                  EQU_T = "equals",
-                  POW_T = "power",
-                  MOD_T = "modulus",
-                  EE_T  = "double-equals",
-                  NE_T  = "not-equal",
-                  LT_T  = "less-than",
-                  GT_T  = "greater-than",
-                  LTE_T = "less-than-or-equal",
-                  GTE_T = "greater-than-or-equal";
+class SourceFile;
 
-const std::vector<std::string> KEYWORDS = {
-  "var",
-  "and",
-  "or",
-  "not",
-  "if",
-  "then",
-  "elif",
-  "else",
-  "for",
-  "to",
-  "step",
-  "while",
-  "do"
-};
-
-using VectorPair = std::pair<std::vector<Token>, std::shared_ptr<Exception>>;
-using TokenPair = std::pair<std::optional<Token>, std::shared_ptr<Exception>>;
 
 class Lexer {
 private:
-  std::string fn, text;
-  Position pos{-1, 0, -1, fn, text};
+  std::shared_ptr<const SourceFile> source;
+  std::string_view text;
+  Position pos;
   char cur_char = '\0';
 
 public:
-  Lexer(const std::string& fn, const std::string& text);
-
+  // the script must have passed check_script_size
+  Lexer(const std::shared_ptr<const SourceFile>& source);
 
-  bool in_keywords(const std::string& text);
   void advance();
-  VectorPair make_tokens();
-  Token make_number();
+  Result<Token> next_token();
+  Result<Token> make_number();
   Token make_identifier();
-  TokenPair make_not_equals();
+  Result<Token> make_not_equals();
   Token make_equals();
   Token make_lt();
   Token make_gt();
 };
 
+// the error for a script longer than positions can point into, nullptr
+// if it fits. callers check once before they make a Lexer for it
+std::shared_ptr<Exception> check_script_size(const SourceFile& source);
+
 using RunType = std::pair<std::optional<RTVariant>, std::shared_ptr<Exception>>;
 
+// how the parsed program is executed
+enum Backend : std::uint8_t {
+  BACKEND_TREE,    // walk the ast (state/interpreter.h)
+  BACKEND_VM,      // compile to bytecode and run that (vm/)
+  BACKEND_CLOSURE  // compile the ast into nested closures (closure/)
+};
+
+struct RunOptions {
+  Backend backend = BACKEND_TREE;
+  // called with the value of every top level statement as it completes
+  StatementSink sink = nullptr;
+  // deeper expressions are a syntax error rather than a stack overflow
+  std::uint32_t max_depth = DEFAULT_MAX_DEPTH;
+};
+
+// the free run functions evaluate on an Engine (engine.h) of their own for
+// each thread, so globals carry over between calls made by one thread
 RunType run(
   const std::string& fn,
-  const std::string& text
+  const std::string& text,
+  const RunOptions& options = {}
+);
+
+// runs an already registered script. lexing, parsing and evaluation happen
+// once for the whole program, the result is the value of its last statement
+RunType run(
+  const std::shared_ptr<const SourceFile>& source,
+  const RunOptions& options = {}
 );
 
 #endif
\ No newline at end of file
@@ -1,60 +1,98 @@
 #include "nodes.h"
 #include "context.h"
 #include "state/interpreter.h"
-#include <memory>
 #include "parser.h"
+#include "arena.h"
 
 // visitors
 
-RTResult VarAccessNode::accept(const Interpreter& visitor, Context& context) {
+Result<Value> VarAccessNode::accept(const Interpreter& visitor, Context& context) {
   return visitor.visit_VarAccessNode(*this, context);
 }
 
-RTResult VarAssignNode::accept(const Interpreter& visitor, Context& context) {
+Result<Value> VarAssignNode::accept(const Interpreter& visitor, Context& context) {
   return visitor.visit_VarAssignNode(*this, context);
 }
 
-RTResult BinOpNode::accept(const Interpreter& visitor, Context& context) {
-  return visitor.visit_BinOpNode(*this, context);
+template<BinaryOp OP>
+Result<Value> BinOpNodeOf<OP>::accept(const Interpreter& visitor, Context& context) {
+  return visitor.visit_BinOpNode<OP>(*this, context);
 }
 
-RTResult UnaryOpNode::accept(const Interpreter& visitor, Context& context) {
-  return visitor.visit_UnaryOpNode(*this, context);
+template<UnaryOp OP>
+Result<Value> UnaryOpNodeOf<OP>::accept(const Interpreter& visitor, Context& context) {
+  return visitor.visit_UnaryOpNode<OP>(*this, context);
 }
 
-RTResult NumberNode::accept(const Interpreter& visitor, Context& context) {
+Result<Value> NumberNode::accept(const Interpreter& visitor, Context& context) {
   return visitor.visit_NumberNode(*this, context);
 }
 
-RTResult IfNode::accept(const Interpreter& visitor, Context& context) {
+Result<Value> IfNode::accept(const Interpreter& visitor, Context& context) {
   return visitor.visit_IfNode(*this, context);
 }
 
-RTResult ForNode::accept(const Interpreter& visitor, Context& context) {
+Result<Value> ForNode::accept(const Interpreter& visitor, Context& context) {
   return visitor.visit_ForNode(*this, context);
 }
 
-RTResult WhileNode::accept(const Interpreter& visitor, Context& context) {
+Result<Value> WhileNode::accept(const Interpreter& visitor, Context& context) {
   return visitor.visit_WhileNode(*this, context);
 }
 
+Result<Value> StatementsNode::accept(const Interpreter& visitor, Context& context) {
+  return visitor.visit_StatementsNode(*this, context);
+}
+
 // end visitors
 
-UnaryOpNode::UnaryOpNode(
-  const Token& op_tok,
-  const std::shared_ptr<ASTNode>& node
-): op_tok(op_tok), node(node) {
-  pos_end = ::get_pos_end(node);
-}
-
-BinOpNode::BinOpNode(
-  const std::shared_ptr<ASTNode>& left_node,
-  const Token& op_tok,
-  const std::shared_ptr<ASTNode>& right_node
-): 
-  left_node(left_node),
-  op_tok(op_tok), 
-  right_node(right_node) {
-  pos_start = ::get_pos_start(left_node);
-  pos_end = ::get_pos_end(right_node);
-}
\ No newline at end of file
+BinOpNode* BinOpNode::make(AstArena& arena, ASTNode* left_node, const Token& op_tok, ASTNode* right_node) {
+  switch(op_tok.type) {
+    case PLS_T: return arena.make<BinOpNodeOf<BIN_ADD>>(left_node, right_node);
+    case MIN_T: return arena.make<BinOpNodeOf<BIN_SUB>>(left_node, right_node);
+    case MUL_T: return arena.make<BinOpNodeOf<BIN_MUL>>(left_node, right_node);
+    case DIV_T: return arena.make<BinOpNodeOf<BIN_DIV>>(left_node, right_node);
+    case POW_T: return arena.make<BinOpNodeOf<BIN_POW>>(left_node, right_node);
+    case MOD_T: return arena.make<BinOpNodeOf<BIN_MOD>>(left_node, right_node);
+    case EE_T:  return arena.make<BinOpNodeOf<BIN_EE>>(left_node, right_node);
+    case NE_T:  return arena.make<BinOpNodeOf<BIN_NE>>(left_node, right_node);
+    case LT_T:  return arena.make<BinOpNodeOf<BIN_LT>>(left_node, right_node);
+    case GT_T:  return arena.make<BinOpNodeOf<BIN_GT>>(left_node, right_node);
+    case LTE_T: return arena.make<BinOpNodeOf<BIN_LTE>>(left_node, right_node);
+    case GTE_T: return arena.make<BinOpNodeOf<BIN_GTE>>(left_node, right_node);
+    default:
+      // the parser only hands over 'and' and 'or' as keyword operators
+      if(op_tok.id == KW_AND) return arena.make<BinOpNodeOf<BIN_AND>>(left_node, right_node);
+      return arena.make<BinOpNodeOf<BIN_OR>>(left_node, right_node);
+  }
+}
+
+UnaryOpNode* UnaryOpNode::make(AstArena& arena, const Token& op_tok, ASTNode* node) {
+  switch(op_tok.type) {
+    case PLS_T: return arena.make<UnaryOpNodeOf<UN_PLUS>>(op_tok.pos_start, node);
+    case MIN_T: return arena.make<UnaryOpNodeOf<UN_MINUS>>(op_tok.pos_start, node);
+    default: return arena.make<UnaryOpNodeOf<UN_NOT>>(op_tok.pos_start, node);
+  }
+}
+
+const ASTNode* value_origin(const ASTNode* node) {
+  while(node->kind == NODE_VAR_ASSIGN) {
+    node = static_cast<const VarAssignNode*>(node)->value_node;
+  }
+
+  return node;
+}
+
+bool may_be_undefined(const ASTNode* node) {
+  switch(node->kind) {
+    case NODE_FOR:
+    case NODE_WHILE: return true;
+    // taken branches always pass a value on
+    case NODE_IF: return !static_cast<const IfNode*>(node)->else_case;
+    case NODE_STATEMENTS: {
+      const auto& statements = static_cast<const StatementsNode*>(node)->statements;
+      return statements.empty() || may_be_undefined(statements.back());
+    }
+    default: return false;
+  }
+}
@@ -2,171 +2,279 @@
 #define NODES
 #include "position.h"
 #include "token.h"
-#include <variant>
-#include <optional>
-#include <memory>
-#include <vector>
+#include "result.h"
+#include "state/value.h"
+#include <algorithm>
+#include <cstdint>
+#include <span>
 
-struct BinOpNode;
-struct UnaryOpNode;
-struct VarAssignNode;
-struct VarAccessNode;
-
-class RTResult;
+class AstArena;
 class Interpreter;
 class Context;
 
-// helpers
-using SharedBin = std::shared_ptr<BinOpNode>;
-using SharedUnary = std::shared_ptr<UnaryOpNode>;
-using SharedAssign = std::shared_ptr<VarAssignNode>;
+// nodes live in an AstArena (see arena.h) and point at their children
+// directly. they keep only the ids and positions evaluation needs, never
+// whole tokens, and must stay trivially destructible
+
+enum NodeKind : std::uint8_t {
+  NODE_NUMBER,
+  NODE_VAR_ACCESS,
+  NODE_VAR_ASSIGN,
+  NODE_BIN_OP,
+  NODE_UNARY_OP,
+  NODE_IF,
+  NODE_FOR,
+  NODE_WHILE,
+  NODE_STATEMENTS
+};
+
+// operators, resolved from their token once when the node is built
+enum BinaryOp : std::uint8_t {
+  BIN_ADD,
+  BIN_SUB,
+  BIN_MUL,
+  BIN_DIV,
+  BIN_POW,
+  BIN_MOD,
+  BIN_EE,
+  BIN_NE,
+  BIN_LT,
+  BIN_GT,
+  BIN_LTE,
+  BIN_GTE,
+  BIN_AND,
+  BIN_OR
+};
+
+enum UnaryOp : std::uint8_t {
+  UN_PLUS,
+  UN_MINUS,
+  UN_NOT
+};
 
 // abstract base class
 struct ASTNode {
-  virtual RTResult accept(const Interpreter& visitor, Context& context) = 0; // visitor
+  // lets compiler passes switch on the node type without going through the
+  // interpreter's visitor
+  const NodeKind kind;
+  // levels from this node down to its deepest leaf, fixed when it is built.
+  // the parser keeps it under a limit, so passes may recurse over the tree
+  std::uint32_t depth;
+
+  ASTNode(NodeKind kind, std::uint32_t depth = 1): kind(kind), depth(depth) {}
+
+  virtual Result<Value> accept(const Interpreter& visitor, Context& context) = 0; // visitor
   virtual Position get_pos_start() const = 0;
   virtual Position get_pos_end() const = 0;
-  virtual ~ASTNode() {}
 };
 
 struct NumberNode : public ASTNode {
-  std::optional<Token> tok;
-  Position pos_start = tok->pos_start.value();
-  Position pos_end = tok->pos_end.value();
+  double value;
+  Position pos_start, pos_end;
 
   NumberNode(const Token& token)
-  : tok(token), pos_start(token.pos_start.value()), pos_end(token.pos_end.value()) {};
+  : ASTNode(NODE_NUMBER), value(token.number), pos_start(token.pos_start), pos_end(token.pos_end) {};
 
-  RTResult accept(const Interpreter& visitor, Context& context) override ;
+  // a constant the folder computed, spanning the expression it replaces
+  NumberNode(double value, const Position& pos_start, const Position& pos_end)
+  : ASTNode(NODE_NUMBER), value(value), pos_start(pos_start), pos_end(pos_end) {};
+
+  Result<Value> accept(const Interpreter& visitor, Context& context) override ;
 
   inline Position get_pos_start() const override { return pos_start; }
   inline Position get_pos_end() const override { return pos_end; }
 };
 
 struct VarAccessNode : public ASTNode {
-  Token var_name_tok;
-
-  Position pos_start = var_name_tok.pos_start.value();
-  Position pos_end = var_name_tok.pos_end.value();
+  std::uint32_t var_name; // interned symbol id
+  std::uint32_t slot = 0; // set by the resolver
+  Position pos_start, pos_end;
 
-  VarAccessNode(const Token& token): var_name_tok(token) {}
+  VarAccessNode(const Token& token)
+    : ASTNode(NODE_VAR_ACCESS), var_name(token.id), pos_start(token.pos_start), pos_end(token.pos_end) {}
 
-  RTResult accept(const Interpreter& visitor, Context& context) override;
+  Result<Value> accept(const Interpreter& visitor, Context& context) override;
 
   inline Position get_pos_start() const override { return pos_start; }
   inline Position get_pos_end() const override { return pos_end; }
 };
 
 struct VarAssignNode : public ASTNode {
-  Token var_name_tok;
-  std::shared_ptr<ASTNode> value_node;
-
-  Position pos_start = var_name_tok.pos_start.value();
-  Position pos_end = var_name_tok.pos_end.value();
+  std::uint32_t var_name;
+  std::uint32_t slot = 0;
+  ASTNode* value_node;
+  Position pos_start, pos_end;
 
-  VarAssignNode(const Token& tok, const std::shared_ptr<ASTNode>& node)
-    : var_name_tok(tok), value_node(node) {}
+  VarAssignNode(const Token& tok, ASTNode* node)
+    : ASTNode(NODE_VAR_ASSIGN, node->depth + 1), var_name(tok.id), value_node(node), pos_start(tok.pos_start), pos_end(tok.pos_end) {}
 
-  RTResult accept(const Interpreter& visitor, Context& context) override;
+  Result<Value> accept(const Interpreter& visitor, Context& context) override;
 
   inline Position get_pos_start() const override { return pos_start; }
   inline Position get_pos_end() const override { return pos_end; }
 };
 
 
+// how the interpreter reads an operand of a BinOpNode. every operand
+// starts out unseen. after the node has run once, a number or variable
+// operand is read in place instead of through its own accept (see
+// Interpreter::quicken)
+enum OperandMode : std::uint8_t {
+  OPERAND_UNSEEN,
+  OPERAND_NODE,
+  OPERAND_CONST,
+  OPERAND_SLOT
+};
+
+// the fields every binary operation shares. the nodes themselves are
+// BinOpNodeOf<op>, so evaluating one is a single virtual call to the code
+// for its operator. build them with make()
 struct BinOpNode : public ASTNode {
-  std::shared_ptr<ASTNode> left_node;
-  Token op_tok;
-  std::shared_ptr<ASTNode> right_node;
-  std::optional<Position> pos_start, pos_end;
-  
-  BinOpNode(
-    const std::shared_ptr<ASTNode>& left_node,
-    const Token& op_tok,
-    const std::shared_ptr<ASTNode>& right_node
-  );
+  ASTNode* left_node;
+  BinaryOp op;
+  OperandMode left_mode = OPERAND_UNSEEN, right_mode = OPERAND_UNSEEN;
+  ASTNode* right_node;
+  Position pos_start, pos_end;
+
+  static BinOpNode* make(AstArena& arena, ASTNode* left_node, const Token& op_tok, ASTNode* right_node);
+
+  inline Position get_pos_start() const override { return pos_start; }
+  inline Position get_pos_end() const override { return pos_end; }
+
+protected:
+  BinOpNode(ASTNode* left_node, BinaryOp op, ASTNode* right_node)
+    : ASTNode(NODE_BIN_OP, std::max(left_node->depth, right_node->depth) + 1),
+    left_node(left_node), op(op), right_node(right_node),
+    pos_start(left_node->get_pos_start()), pos_end(right_node->get_pos_end()) {}
+};
 
-  RTResult accept(const Interpreter& visitor, Context& context) override;
+template<BinaryOp OP>
+struct BinOpNodeOf final : public BinOpNode {
+  BinOpNodeOf(ASTNode* left_node, ASTNode* right_node): BinOpNode(left_node, OP, right_node) {}
 
-  inline Position get_pos_start() const override { return pos_start.value(); }
-  inline Position get_pos_end() const override { return pos_end.value(); }
+  Result<Value> accept(const Interpreter& visitor, Context& context) override;
 };
 
+// same split as BinOpNode
 struct UnaryOpNode : public ASTNode {
-  Token op_tok;
-  std::shared_ptr<ASTNode> node;
-  std::optional<Position> pos_start = op_tok.pos_start.value(), pos_end;
+  UnaryOp op;
+  ASTNode* node;
+  Position pos_start, pos_end;
 
-  UnaryOpNode(
-    const Token& op_tok,
-    const std::shared_ptr<ASTNode>& node
-  );
+  static UnaryOpNode* make(AstArena& arena, const Token& op_tok, ASTNode* node);
 
-  RTResult accept(const Interpreter& visitor, Context& context) override;
+  inline Position get_pos_start() const override { return pos_start; }
+  inline Position get_pos_end() const override { return pos_end; }
 
-  inline Position get_pos_start() const override { return pos_start.value(); }
-  inline Position get_pos_end() const override { return pos_end.value(); }
+protected:
+  UnaryOpNode(UnaryOp op, const Position& pos_start, ASTNode* node)
+    : ASTNode(NODE_UNARY_OP, node->depth + 1), op(op), node(node),
+    pos_start(pos_start), pos_end(node->get_pos_end()) {}
+};
+
+template<UnaryOp OP>
+struct UnaryOpNodeOf final : public UnaryOpNode {
+  UnaryOpNodeOf(const Position& pos_start, ASTNode* node): UnaryOpNode(OP, pos_start, node) {}
+
+  Result<Value> accept(const Interpreter& visitor, Context& context) override;
+};
+
+struct IfCase {
+  ASTNode* condition;
+  ASTNode* expr;
 };
 
 struct IfNode : public ASTNode {
-  std::vector<
-    std::pair<std::shared_ptr<ASTNode>, std::shared_ptr<ASTNode>>
-  > cases;
-  std::shared_ptr<ASTNode> else_case;
+  std::span<IfCase> cases;
+  ASTNode* else_case;
 
   Position pos_start, pos_end;
 
-  IfNode(
-    const std::vector<std::pair<std::shared_ptr<ASTNode>, std::shared_ptr<ASTNode>>>& cases,
-    const std::shared_ptr<ASTNode>& else_case
-  )
-    : cases(cases), else_case(else_case),
-      pos_start(cases.at(0).first->get_pos_start()),
-      pos_end(else_case ? else_case->get_pos_end() : cases.back().first->get_pos_end()) {}
+  IfNode(std::span<IfCase> cases, ASTNode* else_case)
+    : ASTNode(NODE_IF), cases(cases), else_case(else_case),
+      pos_start(cases.front().condition->get_pos_start()),
+      pos_end(else_case ? else_case->get_pos_end() : cases.back().condition->get_pos_end()) {
+    std::uint32_t below = else_case ? else_case->depth : 0;
+    for(const IfCase& c : cases) below = std::max({ below, c.condition->depth, c.expr->depth });
+    depth = below + 1;
+  }
 
-  RTResult accept(const Interpreter& visitor, Context& context) override;
+  Result<Value> accept(const Interpreter& visitor, Context& context) override;
 
   inline Position get_pos_start() const override { return pos_start; }
   inline Position get_pos_end() const override { return pos_end; }
 };
 
 struct ForNode : public ASTNode {
-  Token var_name_tok;
-  std::shared_ptr<ASTNode> start_value, end_value, step_value, body;
+  std::uint32_t var_name;
+  std::uint32_t slot = 0;
+  // set by the resolver, false when the body never reads or writes the
+  // loop variable. then only the value it ends with has to be stored
+  bool var_in_body = true;
+  ASTNode *start_value, *end_value, *step_value, *body;
   Position pos_start, pos_end;
 
   ForNode(
     const Token& var_name_tok,
-    const std::shared_ptr<ASTNode>& start_value,
-    const std::shared_ptr<ASTNode>& end_value,
-    const std::shared_ptr<ASTNode>& step_value,
-    const std::shared_ptr<ASTNode>& body
+    ASTNode* start_value,
+    ASTNode* end_value,
+    ASTNode* step_value,
+    ASTNode* body
   )
-    : var_name_tok(var_name_tok), start_value(start_value),
+    : ASTNode(NODE_FOR), var_name(var_name_tok.id), start_value(start_value),
     end_value(end_value), step_value(step_value), body(body),
-    pos_start(var_name_tok.pos_start.value()), pos_end(body->get_pos_end()) {}
+    pos_start(var_name_tok.pos_start), pos_end(body->get_pos_end()) {
+    std::uint32_t below = std::max({ start_value->depth, end_value->depth, body->depth });
+    if(step_value) below = std::max(below, step_value->depth);
+    depth = below + 1;
+  }
 
-  RTResult accept(const Interpreter& visitor, Context& context) override;
+  Result<Value> accept(const Interpreter& visitor, Context& context) override;
 
   inline Position get_pos_start() const override { return pos_start; }
   inline Position get_pos_end() const override { return pos_end; }
 };
 
-struct WhileNode : public ASTNode {
-  std::shared_ptr<ASTNode> condition, body;
+// a whole program: newline or ';' separated statements
+struct StatementsNode : public ASTNode {
+  std::span<ASTNode*> statements;
   Position pos_start, pos_end;
 
-  WhileNode(
-    const std::shared_ptr<ASTNode>& condition,
-    const std::shared_ptr<ASTNode>& body
+  StatementsNode(
+    std::span<ASTNode*> statements,
+    const Position& pos_start,
+    const Position& pos_end
   )
-    : condition(condition), body(body),
+    : ASTNode(NODE_STATEMENTS), statements(statements), pos_start(pos_start), pos_end(pos_end) {
+    for(const ASTNode* statement : statements) depth = std::max(depth, statement->depth + 1);
+  }
+
+  Result<Value> accept(const Interpreter& visitor, Context& context) override;
+
+  inline Position get_pos_start() const override { return pos_start; }
+  inline Position get_pos_end() const override { return pos_end; }
+};
+
+struct WhileNode : public ASTNode {
+  ASTNode *condition, *body;
+  Position pos_start, pos_end;
+
+  WhileNode(ASTNode* condition, ASTNode* body)
+    : ASTNode(NODE_WHILE, std::max(condition->depth, body->depth) + 1), condition(condition), body(body),
     pos_start(condition->get_pos_start()), pos_end(body->get_pos_end()) {}
 
-  RTResult accept(const Interpreter& visitor, Context& context) override;
+  Result<Value> accept(const Interpreter& visitor, Context& context) override;
 
   inline Position get_pos_start() const override { return pos_start; }
   inline Position get_pos_end() const override { return pos_end; }
 };
 
-#endif
\ No newline at end of file
+// the node a value computed by node takes its position from: an assignment
+// evaluates to the value it stored. division by zero blames the divisor's
+const ASTNode* value_origin(const ASTNode* node);
+
+// whether node can leave "no value" behind. evaluation reads that as -1
+// wherever a node passes an operand on: in if branches and under unary '+'
+bool may_be_undefined(const ASTNode* node);
+
+#endif
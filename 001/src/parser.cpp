@@ -3,501 +3,396 @@
 #include "lexer.h"
 #include "nodes.h"
 #include "token.h"
-#include <algorithm>
 #include <memory>
 #include <string>
-#include <type_traits>
 
-// parse result
-void ParseResult::register_advance() {
-  advance_count++;
-}
+// parser
 
-std::shared_ptr<ASTNode> ParseResult::register_(const ParseResult& res) {
-  this->advance_count += res.advance_count;
-  if(res.error) this->error = res.error;
-  return res.node;
+Parser::Parser(TokenStream& tokens, AstArena& arena, std::uint32_t max_depth)
+  : tokens(tokens), arena(arena), cur_tok(std::nullopt), max_depth(max_depth) {
+  advance();
 }
 
-ParseResult& ParseResult::success(const std::shared_ptr<ASTNode>& node) {
-  this->node = node;
-  return *this;
+Failure Parser::too_deep(const Position& pos_start, const Position& pos_end) const {
+  return fail(std::make_shared<InvalidSyntaxException>(
+    pos_start, pos_end,
+    std::string("expression nested too deeply, the limit is ") + std::to_string(max_depth) + " levels"
+  ));
 }
 
-ParseResult& ParseResult::failure(const std::shared_ptr<Exception>& error) {
-  if(!this->error || advance_count == 0)
-    this->error = error;
-  return *this;
+Token Parser::advance() {
+  consumed++;
+  cur_tok = tokens.next();
+  return cur_tok.value();
 }
 
-// end parse result
+Result<ASTNode*> Parser::parse() {
+  Result<ASTNode*> res = statements();
 
-// parser
+  if(res && cur_tok->type != EOF_T) {
+    return fail(std::make_shared<InvalidSyntaxException>(
+      cur_tok->pos_start, cur_tok->pos_end,
+      "expected '+', '-', '*', '/', '^', '==', '!=', '<', '>', <=', '>=', 'and' or 'or', got "
+      + kind_name(cur_tok->type)
+    ));
+  }
 
-Parser::Parser(const std::vector<Token>& tokens): tokens(tokens), cur_tok(std::nullopt) {
-  advance();
+  return res;
 }
 
-Token Parser::advance() {
-  tok_idx++;
-  if(tok_idx < (int)tokens.size()) {
-    cur_tok = tokens.at(tok_idx);
+Result<ASTNode*> Parser::statements() {
+  std::vector<ASTNode*> statements = {};
+  Position pos_start = cur_tok->pos_start;
+
+  while(cur_tok->type == NEWL_T) {
+    advance();
   }
 
-  return cur_tok.value();
-}
+  while(cur_tok->type != EOF_T) {
+    Result<ASTNode*> statement = expr();
+    if(!statement) return statement;
 
-ParseResult Parser::parse() {
-  ParseResult res;
-  res.node = res.register_(expr());
+    statements.push_back(statement.value());
 
-  if(!res.error && cur_tok->type != EOF_T) {
-    return res.failure(std::make_shared<InvalidSyntaxException>(
-      cur_tok->pos_start.value(), cur_tok->pos_end.value(),
-      "expected '+', '-', '*', '/', '^', '==', '!=', '<', '>', <=', '>=', 'and' or 'or', got "
-      + cur_tok->type
-    ));
+    // statements need at least one separator between them
+    if(cur_tok->type != NEWL_T) break;
+
+    while(cur_tok->type == NEWL_T) {
+      advance();
+    }
   }
 
-  return res;
+  return arena.make<StatementsNode>(
+    arena.make_array(statements), pos_start, cur_tok->pos_end
+  );
 }
 
-ParseResult Parser::power() {
-  return bin_op([this]() { return atom(); }, { POW_T, MOD_T }, [this]() { return factor(); });
-}
+Result<ASTNode*> Parser::if_expr() {
+  std::vector<IfCase> cases = {};
+  ASTNode* else_case = nullptr;
 
-ParseResult Parser::if_expr() {
-  ParseResult res;
-  std::vector<
-    std::pair<std::shared_ptr<ASTNode>, std::shared_ptr<ASTNode>>
-  > cases = {};
-  std::shared_ptr<ASTNode> else_case = nullptr;
-
-  if(!cur_tok->matches(KWD_T, "if")) {
-    return res.failure(std::make_shared<InvalidSyntaxException>(
-      cur_tok->pos_start.value(), cur_tok->pos_end.value(),
-      "expected 'if', got " + cur_tok->type
+  if(!cur_tok->matches(KWD_T, KW_IF)) {
+    return fail(std::make_shared<InvalidSyntaxException>(
+      cur_tok->pos_start, cur_tok->pos_end,
+      std::string("expected 'if', got ") + kind_name(cur_tok->type)
     ));
   }
 
-  res.register_advance();
   advance();
 
-  std::shared_ptr<ASTNode> condition = res.register_(expr());
-  if(res.error) return res;
+  Result<ASTNode*> condition = expr();
+  if(!condition) return condition;
 
-  if(!cur_tok->matches(KWD_T, "then")) {
-    return res.failure(std::make_shared<InvalidSyntaxException>(
-      cur_tok->pos_start.value(), cur_tok->pos_end.value(),
-      "expected 'then' after 'if' expression got " + cur_tok->type
+  if(!cur_tok->matches(KWD_T, KW_THEN)) {
+    return fail(std::make_shared<InvalidSyntaxException>(
+      cur_tok->pos_start, cur_tok->pos_end,
+      std::string("expected 'then' after 'if' expression got ") + kind_name(cur_tok->type)
     ));
   }
 
-  res.register_advance();
   advance();
 
-  std::shared_ptr<ASTNode> expr_res = res.register_(expr());
-  if(res.error) return res;
+  Result<ASTNode*> expr_res = expr();
+  if(!expr_res) return expr_res;
 
-  cases.emplace_back(condition, expr_res);
+  cases.push_back({ condition.value(), expr_res.value() });
 
-  while(cur_tok->matches(KWD_T, "elif")) {
-    res.register_advance();
+  while(cur_tok->matches(KWD_T, KW_ELIF)) {
     advance();
 
-    condition = res.register_(expr());
-    if(res.error) return res;
+    condition = expr();
+    if(!condition) return condition;
 
-    if(!cur_tok->matches(KWD_T, "then")) {
-      return res.failure(std::make_shared<InvalidSyntaxException>(
-        cur_tok->pos_start.value(), cur_tok->pos_end.value(),
-        "expected 'then' after 'elif' expression, got " + cur_tok->type
+    if(!cur_tok->matches(KWD_T, KW_THEN)) {
+      return fail(std::make_shared<InvalidSyntaxException>(
+        cur_tok->pos_start, cur_tok->pos_end,
+        std::string("expected 'then' after 'elif' expression, got ") + kind_name(cur_tok->type)
       ));
     }
 
-    res.register_advance();
     advance();
 
-    expr_res = res.register_(expr());
-    if(res.error) return res;
+    expr_res = expr();
+    if(!expr_res) return expr_res;
 
-    cases.emplace_back(condition, expr_res);
+    cases.push_back({ condition.value(), expr_res.value() });
   }
 
-  if(cur_tok->matches(KWD_T, "else")) {
-    res.register_advance();
+  if(cur_tok->matches(KWD_T, KW_ELSE)) {
     advance();
 
-    else_case = res.register_(expr());
-    if(res.error) return res;
+    Result<ASTNode*> else_res = expr();
+    if(!else_res) return else_res;
+
+    else_case = else_res.value();
   }
 
-  return res.success(std::make_shared<IfNode>(cases, else_case));
+  return arena.make<IfNode>(arena.make_array(cases), else_case);
 }
 
-ParseResult Parser::for_expr() {
-  ParseResult res;
-
-  if(!cur_tok->matches(KWD_T, "for")) {
-    return res.failure(std::make_shared<InvalidSyntaxException>(
-      cur_tok->pos_start.value(), cur_tok->pos_end.value(),
-      "expected 'for', got " + cur_tok->type
+Result<ASTNode*> Parser::for_expr() {
+  if(!cur_tok->matches(KWD_T, KW_FOR)) {
+    return fail(std::make_shared<InvalidSyntaxException>(
+      cur_tok->pos_start, cur_tok->pos_end,
+      std::string("expected 'for', got ") + kind_name(cur_tok->type)
     ));
   }
 
-  res.register_advance();
   advance();
 
   if(cur_tok->type != ID_T) {
-    return res.failure(std::make_shared<InvalidSyntaxException>(
-      cur_tok->pos_start.value(), cur_tok->pos_end.value(),
-      "expected identifier after 'for', got " + cur_tok->type
+    return fail(std::make_shared<InvalidSyntaxException>(
+      cur_tok->pos_start, cur_tok->pos_end,
+      std::string("expected identifier after 'for', got ") + kind_name(cur_tok->type)
     ));
   }
 
   Token var_name = cur_tok.value();
-  res.register_advance();
   advance();
 
   if(cur_tok->type != EQU_T) {
-    return res.failure(std::make_shared<InvalidSyntaxException>(
-      cur_tok->pos_start.value(), cur_tok->pos_end.value(),
-      "expected '=' after identifier, got " + cur_tok->type
+    return fail(std::make_shared<InvalidSyntaxException>(
+      cur_tok->pos_start, cur_tok->pos_end,
+      std::string("expected '=' after identifier, got ") + kind_name(cur_tok->type)
     ));
   }
 
-  res.register_advance();
   advance();
 
-  std::shared_ptr<ASTNode> start_value = res.register_(expr());
-  if(res.error) return res;
+  Result<ASTNode*> start_value = expr();
+  if(!start_value) return start_value;
 
-  if(!cur_tok->matches(KWD_T, "to")) {
-    return res.failure(std::make_shared<InvalidSyntaxException>(
-      cur_tok->pos_start.value(), cur_tok->pos_end.value(),
-      "expected 'to' after equals, got " + cur_tok->type
+  if(!cur_tok->matches(KWD_T, KW_TO)) {
+    return fail(std::make_shared<InvalidSyntaxException>(
+      cur_tok->pos_start, cur_tok->pos_end,
+      std::string("expected 'to' after equals, got ") + kind_name(cur_tok->type)
     ));
   }
 
-  res.register_advance();
   advance();
 
-  std::shared_ptr<ASTNode> end_value = res.register_(expr());
-  if(res.error) return res;
+  Result<ASTNode*> end_value = expr();
+  if(!end_value) return end_value;
 
-  std::shared_ptr<ASTNode> step_value;
+  ASTNode* step_value = nullptr;
 
-  if(cur_tok->matches(KWD_T, "step")) {
-    res.register_advance();
+  if(cur_tok->matches(KWD_T, KW_STEP)) {
     advance();
 
-    step_value = res.register_(expr());
-    if(res.error) return res;
-  } else {
-    step_value = nullptr;
+    Result<ASTNode*> step_res = expr();
+    if(!step_res) return step_res;
+
+    step_value = step_res.value();
   }
 
-  if(!cur_tok->matches(KWD_T, "do")) {
-    return res.failure(std::make_shared<InvalidSyntaxException>(
-      cur_tok->pos_start.value(), cur_tok->pos_end.value(),
-      "expected 'do' after 'for' expression, got " + cur_tok->type
+  if(!cur_tok->matches(KWD_T, KW_DO)) {
+    return fail(std::make_shared<InvalidSyntaxException>(
+      cur_tok->pos_start, cur_tok->pos_end,
+      std::string("expected 'do' after 'for' expression, got ") + kind_name(cur_tok->type)
     ));
   }
 
-  res.register_advance();
   advance();
 
-  std::shared_ptr<ASTNode> body = res.register_(expr());
-  if(res.error) return res;
+  Result<ASTNode*> body = expr();
+  if(!body) return body;
 
-  return res.success(std::make_shared<ForNode>(
-    var_name, start_value, end_value, step_value, body
-  ));
+  return arena.make<ForNode>(
+    var_name, start_value.value(), end_value.value(), step_value, body.value()
+  );
 }
 
-ParseResult Parser::while_expr() {
-  ParseResult res;
-
-  if(!cur_tok->matches(KWD_T, "while")) {
-    return res.failure(std::make_shared<InvalidSyntaxException>(
-      cur_tok->pos_start.value(), cur_tok->pos_end.value(),
-      "expected 'while', got " + cur_tok->type
+Result<ASTNode*> Parser::while_expr() {
+  if(!cur_tok->matches(KWD_T, KW_WHILE)) {
+    return fail(std::make_shared<InvalidSyntaxException>(
+      cur_tok->pos_start, cur_tok->pos_end,
+      std::string("expected 'while', got ") + kind_name(cur_tok->type)
     ));
   }
 
-  res.register_advance();
   advance();
 
-  std::shared_ptr<ASTNode> condition = res.register_(expr());
-  if(res.error) return res;
+  Result<ASTNode*> condition = expr();
+  if(!condition) return condition;
 
-  if(!cur_tok->matches(KWD_T, "do")) {
-    return res.failure(std::make_shared<InvalidSyntaxException>(
-      cur_tok->pos_start.value(), cur_tok->pos_end.value(),
-      "expected 'do' after condition, got " + cur_tok->type
+  if(!cur_tok->matches(KWD_T, KW_DO)) {
+    return fail(std::make_shared<InvalidSyntaxException>(
+      cur_tok->pos_start, cur_tok->pos_end,
+      std::string("expected 'do' after condition, got ") + kind_name(cur_tok->type)
     ));
   }
 
-  res.register_advance();
   advance();
 
-  std::shared_ptr<ASTNode> body = res.register_(expr());
-  if(res.error) return res;
+  Result<ASTNode*> body = expr();
+  if(!body) return body;
 
-  return res.success(std::make_shared<WhileNode>(condition, body));
+  return arena.make<WhileNode>(condition.value(), body.value());
 }
 
-ParseResult Parser::atom() {
-  ParseResult res;
+Result<ASTNode*> Parser::atom() {
   Token tok = cur_tok.value();
 
   if(tok.type == INT_T || tok.type == FLT_T) {
-    res.register_advance();
     advance();
-    return res.success(std::make_shared<NumberNode>(tok));
+    return arena.make<NumberNode>(tok);
 
   } else if(tok.type == ID_T) {
-    res.register_advance();
     advance();
-    return res.success(std::make_shared<VarAccessNode>(tok));
+    return arena.make<VarAccessNode>(tok);
 
   } else if(tok.type == LPR_T) {
-    res.register_advance();
     advance();
-    ParseResult expr_res = expr();
-    res.register_(expr_res);
 
-    if(res.error) return res;
+    Result<ASTNode*> expr_res = expr();
+    if(!expr_res) return expr_res;
 
     if(cur_tok->type == RPR_T) {
-      res.register_advance();
       advance();
-      return res.success(expr_res.node);
+      return expr_res;
 
     } else {
-      return res.failure(std::make_shared<InvalidSyntaxException>(
-        cur_tok->pos_start.value(), cur_tok->pos_end.value(),
-        "expected ')', got " + cur_tok->type
+      return fail(std::make_shared<InvalidSyntaxException>(
+        cur_tok->pos_start, cur_tok->pos_end,
+        std::string("expected ')', got ") + kind_name(cur_tok->type)
       ));
     }
 
-  } else if(cur_tok->matches(KWD_T, "if")) {
-    std::shared_ptr<ASTNode> if_expr_res = res.register_(if_expr());
-
-    if(res.error) return res;
-    return res.success(if_expr_res);
-
-  } else if(cur_tok->matches(KWD_T, "for")) {
-    std::shared_ptr<ASTNode> for_expr_res = res.register_(for_expr());
+  } else if(cur_tok->matches(KWD_T, KW_IF)) {
+    return if_expr();
 
-    if(res.error) return res;
-    return res.success(for_expr_res);
+  } else if(cur_tok->matches(KWD_T, KW_FOR)) {
+    return for_expr();
 
-  } else if(cur_tok->matches(KWD_T, "while")) {
-    std::shared_ptr<ASTNode> while_expr_res = res.register_(while_expr());
-
-    if(res.error) return res;
-    return res.success(while_expr_res);
+  } else if(cur_tok->matches(KWD_T, KW_WHILE)) {
+    return while_expr();
   }
   
-  return res.failure(std::make_shared<InvalidSyntaxException>(
-    tok.pos_start.value(), tok.pos_end.value(),
-    "expected int, float, identifier, '+', '-' or '(', got " + tok.type
+  return fail(std::make_shared<InvalidSyntaxException>(
+    tok.pos_start, tok.pos_end,
+    std::string("expected int, float, identifier, '+', '-' or '(', got ") + kind_name(tok.type)
   ));
 }
 
-ParseResult Parser::factor() {
-  ParseResult res;
-  Token tok = cur_tok.value();
-
-  if(tok.type == PLS_T || tok.type == MIN_T) {
-    res.register_advance();
-    advance();
-    std::shared_ptr<ASTNode> node = res.register_(factor());
-
-    if(res.error) return res;
-
-    return res.success(std::make_shared<UnaryOpNode>(tok, node));
-  }
-
-  return power();
-}
-
-ParseResult Parser::term() {
-  return bin_op([this]() { return factor(); }, { MUL_T, DIV_T });
-}
-
-ParseResult Parser::arith_expr() {
-  return bin_op([this]() { return term(); }, { PLS_T, MIN_T });
+Result<ASTNode*> Parser::expr() {
+  return expression(BP_NONE);
 }
 
-ParseResult Parser::comp_expr() {
-  ParseResult res;
-  std::optional<Token> op_tok;
-
-  if(cur_tok->matches(KWD_T, "not")) {
-    op_tok = cur_tok;
-    res.register_advance();
-    advance();
+Result<ASTNode*> Parser::var_expr() {
+  advance();
 
-    std::shared_ptr<ASTNode> node_expr = res.register_(bin_op(
-      [this]() { return comp_expr(); }, { EE_T, NE_T, LT_T, GT_T, LTE_T, GTE_T }
+  if(cur_tok->type != ID_T) {
+    return fail(std::make_shared<InvalidSyntaxException>(
+      cur_tok->pos_start, cur_tok->pos_end,
+      std::string("expected identifier after 'var', got ") + kind_name(cur_tok->type)
     ));
+  }
 
-    if(res.error) return res;
+  Token var_name = cur_tok.value();
+  advance();
 
-    return res.success(std::make_shared<UnaryOpNode>(op_tok.value(), node_expr));
+  if(cur_tok->type != EQU_T) {
+    return fail(std::make_shared<InvalidSyntaxException>(
+      cur_tok->pos_start, cur_tok->pos_end,
+      std::string("expected '=' after identifier, got ") + kind_name(cur_tok->type)
+    ));
   }
 
-  std::shared_ptr<ASTNode> node_expr = res.register_(bin_op(
-    [this]() { return arith_expr(); }, { EE_T, NE_T, LT_T, GT_T, LTE_T, GTE_T }
-  ));
+  advance();
 
-  if(res.error)
-    return res.failure(std::make_shared<InvalidSyntaxException>(
-      cur_tok->pos_start.value(), cur_tok->pos_end.value(),
-      "expected int, float, identifier, '+', '-', '(' or 'not'"
-    ));
+  Result<ASTNode*> other_expr = expr();
+  if(!other_expr) return other_expr;
 
-  return res.success(node_expr);
+  return arena.make<VarAssignNode>(var_name, other_expr.value());
 }
 
-ParseResult Parser::expr() {
-  ParseResult res;
+Result<ASTNode*> Parser::prefix(int min_power) {
+  // 'var' only starts a full expression, 'not' only an operand of and/or
+  if(min_power == BP_NONE && cur_tok->matches(KWD_T, KW_VAR)) {
+    return var_expr();
+  }
 
-  if(cur_tok->matches(KWD_T, "var")) {
-    res.register_advance();
+  if(min_power <= BP_LOGIC && cur_tok->matches(KWD_T, KW_NOT)) {
+    Token op_tok = cur_tok.value();
     advance();
 
-    if(cur_tok->type != ID_T) {
-      return res.failure(std::make_shared<InvalidSyntaxException>(
-        cur_tok->pos_start.value(), cur_tok->pos_end.value(),
-        "expected identifier after 'var', got " + cur_tok->type
-      ));
-    }
+    Result<ASTNode*> node = expression(BP_LOGIC);
+    if(!node) return node;
 
-    Token var_name = cur_tok.value();
-    res.register_advance();
-    advance();
-
-    if(cur_tok->type != EQU_T) {
-      return res.failure(std::make_shared<InvalidSyntaxException>(
-        cur_tok->pos_start.value(), cur_tok->pos_end.value(),
-        "expected '=' after identifier, got " + cur_tok->type
-      ));
-    }
+    return UnaryOpNode::make(arena, op_tok, node.value());
+  }
 
-    res.register_advance();
+  if(cur_tok->type == PLS_T || cur_tok->type == MIN_T) {
+    Token op_tok = cur_tok.value();
     advance();
-    std::shared_ptr<ASTNode> other_expr = res.register_(expr());
 
-    if(res.error) return res;
+    // a sign covers a following power: -2^2 is -(2^2)
+    Result<ASTNode*> node = expression(BP_TERM);
+    if(!node) return node;
 
-    // return res.success(VarAssignNode(var_name, other_expr));
-    return res.success(std::make_shared<VarAssignNode>(var_name, other_expr));
+    return UnaryOpNode::make(arena, op_tok, node.value());
   }
 
-  ParseResult node = bin_op(
-    [this]() { return comp_expr(); }, { {KWD_T, "and"}, {KWD_T, "or"} }
-  );
-  res.register_(node);
+  return atom();
+}
 
-  if(res.error) { 
-    return res.failure(std::make_shared<InvalidSyntaxException>(
-      cur_tok->pos_start.value(), cur_tok->pos_end.value(),
-      "expected 'var', int, float, identifier, '+', '-', '(' or 'not'"
-    ));
-  }
+Result<ASTNode*> Parser::expression(int min_power) {
+  if(nesting >= max_depth) return too_deep(cur_tok->pos_start, cur_tok->pos_end);
 
-  return res.success(node.node);
-}
+  nesting++;
+  Result<ASTNode*> node = infix_expression(min_power);
+  nesting--;
 
-ParseResult Parser::bin_op(
-  const std::function<ParseResult()>& func_a,
-  const std::vector<std::pair<std::string, std::string>>& ops,
-  const std::optional<std::function<ParseResult()>>& func_b
-) { // overload with { {tok_type, tok_value} }
-  std::function<ParseResult()> other_func = func_b.value_or(func_a);
-
-  ParseResult res; // parseresult object
-  ParseResult left_res = func_a(); // parseresult extracted from func_a()
-
-  std::shared_ptr<ASTNode> left = res.register_(left_res); // extract node from left_res
-  if(res.error) return res; // check if theres an error and if yes, return early
-  std::string target_name = cur_tok->type;
-
-  while(
-    cur_tok &&
-    std::find_if(ops.begin(), ops.end(), [&](const auto& p) -> bool {
-      std::optional<TokenValue> target_value = cur_tok->value;
-
-      if(!target_value) return false;
-
-      return std::visit([&](const auto& val) -> bool {
-        if constexpr(std::is_same_v<std::decay_t<decltype(val)>, std::string>) {
-          return p.first == cur_tok->type && p.second == val;
-        } else {
-          return false;
-        }
-      }, target_value.value());
-    }) != ops.end()
-  ) { // check while cur_tok exists and
-    // the type/value is in the vector
-    Token op_tok = cur_tok.value(); // get operator token which is just current token
-    res.register_advance();
-    advance(); // advance
-    ParseResult right_res = other_func(); // parseresult extracted from func()
-    std::shared_ptr<ASTNode> right = res.register_(right_res); // extract node from right_res
-
-    if(res.error) return res; // if theres an error return early
-
-
-    left = std::make_shared<BinOpNode>(left, op_tok, right); // finally, make
-    // a shared binopnode pointer consisting of the 3 elements
+  // a node built from expressions within the limit is at most one level deeper
+  if(node && node.value()->depth > max_depth) {
+    return too_deep(node.value()->get_pos_start(), node.value()->get_pos_end());
   }
 
-  return res.success(left);
+  return node;
 }
 
-ParseResult Parser::bin_op(
-    const std::function<ParseResult()>& func_a,
-    const std::vector<std::string>& ops,
-    const std::optional<std::function<ParseResult()>>& func_b
-) { // normal
-  std::function<ParseResult()> other_func = func_b.value_or(func_a);
+Result<ASTNode*> Parser::infix_expression(int min_power) {
+  std::size_t start = consumed;
+  Result<ASTNode*> left = prefix(min_power);
+
+  // nothing could be parsed at all: say what may start an expression at
+  // this level. an error after some tokens were taken is more precise
+  if(!left && consumed == start) {
+    if(min_power == BP_NONE) {
+      return fail(std::make_shared<InvalidSyntaxException>(
+        cur_tok->pos_start, cur_tok->pos_end,
+        "expected 'var', int, float, identifier, '+', '-', '(' or 'not'"
+      ));
+    } else if(min_power == BP_LOGIC) {
+      return fail(std::make_shared<InvalidSyntaxException>(
+        cur_tok->pos_start, cur_tok->pos_end,
+        "expected int, float, identifier, '+', '-', '(' or 'not'"
+      ));
+    }
+  }
 
-  ParseResult res; // parseresult object
-  ParseResult left_res = func_a(); // parseresult extracted from func_a()
-  std::shared_ptr<ASTNode> left = res.register_(left_res); // extract node from left_res
+  if(!left) return left;
 
-  if(res.error) return res; // check if theres an error and if yes, return early
+  // one iteration per operator, no matter how many precedence levels it skips
+  while(true) {
+    int power = infix_power(cur_tok.value());
+    if(power <= min_power) break;
 
-  while(
-    std::find(ops.begin(), ops.end(), cur_tok->type) != ops.end()
-  ) { // check while cur_tok exists and
-      // the type/value is in the vector
-      Token op_tok = cur_tok.value(); // get operator token which is just current token
-      res.register_advance();
-    advance(); // advance
-      ParseResult right_res = other_func(); // parseresult extracted from func()
-      std::shared_ptr<ASTNode> right = res.register_(right_res); // extract node from right_res
+    Token op_tok = cur_tok.value();
+    advance();
 
-      if(res.error) return res; // if theres an error return early
+    // ^ and % are right associative and their right side may carry a sign
+    Result<ASTNode*> right = expression(power == BP_POWER ? BP_TERM : power);
+    if(!right) return right;
 
+    left = BinOpNode::make(arena, left.value(), op_tok, right.value());
 
-      left = std::make_shared<BinOpNode>(left, op_tok, right); // finally, make
-      // a shared binopnode pointer consisting of the 3 elements
+    // long chains of left associative operators deepen the tree without
+    // nesting any calls here
+    if(left.value()->depth > max_depth) return too_deep(op_tok.pos_start, op_tok.pos_end);
   }
 
-  return res.success(left);
-}
-
-Position get_pos_end(const std::shared_ptr<ASTNode>& node) {
-  return node->get_pos_end();
-}
-
-Position get_pos_start(const std::shared_ptr<ASTNode>& node) {
-  return node->get_pos_start();
+  return left;
 }
 
-// end parser
\ No newline at end of file
+// end parser
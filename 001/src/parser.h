@@ -1,73 +1,92 @@
 #ifndef PARSER
 #define PARSER
 
-#include <functional>
+#include <array>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <variant>
 #include <vector>
+#include "arena.h"
 #include "token.h"
+#include "token_stream.h"
 #include "exception.h"
+#include "result.h"
 #include "nodes.h"
 
-class ParseResult;
+// binding powers, higher binds tighter. all binary operators are left
+// associative except ^ and %, whose right side is a signed operand
+enum BindingPower : int {
+  BP_NONE = 0,
+  BP_LOGIC,  // and or
+  BP_COMP,   // == != < > <= >=
+  BP_ARITH,  // + -
+  BP_TERM,   // * /
+  BP_POWER   // ^ %
+};
+
+constexpr std::array<std::uint8_t, NEWL_T + 1> make_infix_powers() {
+  std::array<std::uint8_t, NEWL_T + 1> powers{};
+
+  powers[PLS_T] = powers[MIN_T] = BP_ARITH;
+  powers[MUL_T] = powers[DIV_T] = BP_TERM;
+  powers[POW_T] = powers[MOD_T] = BP_POWER;
+  powers[EE_T] = powers[NE_T] = powers[LT_T] = BP_COMP;
+  powers[GT_T] = powers[LTE_T] = powers[GTE_T] = BP_COMP;
+
+  return powers;
+}
+
+constexpr std::array<std::uint8_t, NEWL_T + 1> INFIX_POWERS = make_infix_powers();
+
+inline int infix_power(const Token& tok) {
+  if(tok.type == KWD_T) return (tok.id == KW_AND || tok.id == KW_OR) ? BP_LOGIC : BP_NONE;
+  return INFIX_POWERS[tok.type];
+}
+
+// how deeply expressions may nest by default. every pass over the tree
+// (parsing itself, resolving, folding, the compilers and the tree walker)
+// recurses once per level, so callers lower the limit to what the stack of
+// their thread can take (stack_limit.h). a run of left associative
+// operators nests too: a + b + c is (a + b) + c, one level per operator
+constexpr std::uint32_t DEFAULT_MAX_DEPTH = 4000;
 
 // parser class
 
 class Parser {
 private:
-  std::vector<Token> tokens;
+  TokenStream& tokens;
+  AstArena& arena;
   std::optional<Token> cur_tok;
-  int tok_idx = -1;
+  // tokens taken so far, tells whether a failed rule got anywhere
+  std::size_t consumed = 0;
+  // deepest tree accepted, and expression() calls currently open
+  std::uint32_t max_depth;
+  std::uint32_t nesting = 0;
 
-public:
-  Parser(const std::vector<Token>& tokens);
+  Failure too_deep(const Position& pos_start, const Position& pos_end) const;
 
-  Token advance();
-  ParseResult parse();
-  ParseResult atom();
-  ParseResult factor();
-  ParseResult term();
-  ParseResult expr();
-  ParseResult power();
-  ParseResult comp_expr();
-  ParseResult arith_expr();
-  ParseResult if_expr();
-  ParseResult while_expr();
-  ParseResult for_expr();
-  ParseResult bin_op(
-    const std::function<ParseResult()>& func_a,
-    const std::vector<std::pair<std::string, std::string>>& ops,
-    const std::optional<std::function<ParseResult()>>& func_b = std::nullopt
-  );
-  ParseResult bin_op(
-    const std::function<ParseResult()>& func_a,
-    const std::vector<std::string>& ops,
-    const std::optional<std::function<ParseResult()>>& func_b = std::nullopt
-  );
-};
-
-using RegisterVariant = std::variant<
-  std::shared_ptr<ASTNode>,
-  ParseResult
->;
-
-class ParseResult {
 public:
-  int advance_count = 0;
-
-  std::shared_ptr<Exception> error = nullptr;
-  std::shared_ptr<ASTNode> node = nullptr;
-  std::shared_ptr<ASTNode> register_(const ParseResult& res);
-  void register_advance();
-  ParseResult& success(const std::shared_ptr<ASTNode>& node);
-  ParseResult& failure(const std::shared_ptr<Exception>& error);
+  // every node is allocated from arena, which must outlive the tree
+  Parser(TokenStream& tokens, AstArena& arena, std::uint32_t max_depth = DEFAULT_MAX_DEPTH);
 
+  Token advance();
+  Result<ASTNode*> parse();
+  Result<ASTNode*> statements();
+  Result<ASTNode*> expr();
+  Result<ASTNode*> atom();
+  Result<ASTNode*> if_expr();
+  Result<ASTNode*> while_expr();
+  Result<ASTNode*> for_expr();
+  Result<ASTNode*> var_expr();
+  // any expression binding tighter than min_power, failing cleanly rather
+  // than nesting deeper than max_depth
+  Result<ASTNode*> expression(int min_power);
+  // pratt parser: operand, then every infix operator binding tighter than min_power
+  Result<ASTNode*> infix_expression(int min_power);
+  Result<ASTNode*> prefix(int min_power);
 };
 
-Position get_pos_end(const std::shared_ptr<ASTNode>& node);
-Position get_pos_start(const std::shared_ptr<ASTNode>& node);
-
 // end parser
 
 #endif
\ No newline at end of file
@@ -1,26 +1,29 @@
 #include "position.h"
+#include "source.h"
 
-Position::Position(int idx, int ln, int col, const std::string& fn, const std::string& ftxt)
-  : idx(idx), ln(ln), col(col), fn(fn), ftxt(ftxt) {}
+Position::Position(int idx, std::uint32_t file_id)
+  : idx(idx), file_id(file_id) {}
 
-Position& Position::advance(char cur_char) {
+Position& Position::advance() {
   idx++;
-  col++;
-
-  if(cur_char == '\n') {
-    ln++;
-    col = 0;
-  }
-
   return *this;
 }
 
 Position Position::copy() const {
-  return Position(idx, ln, col, fn, ftxt);
+  return Position(idx, file_id);
+}
+
+int Position::get_ln() const {
+  auto file = SourceManager::instance().get(file_id);
+  return file ? file->line_of(idx) : 0;
 }
 
-int Position::get_col() const { return col; }
-int Position::get_idx() const { return idx; }
-int Position::get_ln() const { return ln; }
-std::string Position::get_fn() const { return fn; }
-std::string Position::get_ftxt() const { return ftxt; }
\ No newline at end of file
+int Position::get_col() const {
+  auto file = SourceManager::instance().get(file_id);
+  return file ? file->col_of(idx) : idx;
+}
+
+std::string Position::get_fn() const {
+  auto file = SourceManager::instance().get(file_id);
+  return file ? file->get_fn() : "";
+}
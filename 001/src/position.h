@@ -1,27 +1,35 @@
 #ifndef POSITION
 #define POSITION
 
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <string>
+#include <string_view>
 
+// the largest script the lexer takes. a Position holds an int offset to
+// keep tokens and nodes small. data files are never lexed and may be larger
+constexpr std::size_t MAX_SCRIPT_SIZE = std::numeric_limits<int>::max();
+
+// a byte offset into a script registered with the SourceManager.
+// line and column are only worked out when an error needs them
 class Position {
 private:
   int idx = 0;
-  int ln = 0;
-  int col = 0;
-  std::string fn, ftxt;
+  std::uint32_t file_id = 0;
 
 public:
-  Position(int idx, int ln, int col, const std::string& fn, const std::string& ftxt);
+  Position(int idx = 0, std::uint32_t file_id = 0);
 
-  Position& advance(char cur_char = '\0');
+  Position& advance();
 
   Position copy() const;
 
-  int get_idx() const;
+  inline int get_idx() const { return idx; }
+  inline std::uint32_t get_file() const { return file_id; }
   int get_ln() const;
   int get_col() const;
   std::string get_fn() const;
-  std::string get_ftxt() const;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,91 @@
+#include "program.h"
+#include "folder.h"
+#include "resolver.h"
+#include "source.h"
+#include "stack_limit.h"
+#include "symbols.h"
+#include "token_stream.h"
+#include "state/interpreter.h"
+#include <algorithm>
+
+// bindings
+
+Bindings::Bindings(const SymbolTable& layout): context("<module>") {
+  context.symbol_table = std::make_shared<SymbolTable>(layout);
+}
+
+// end bindings
+
+// program
+
+CompileResult Program::compile(
+  const std::shared_ptr<const SourceFile>& source,
+  std::uint32_t max_depth
+) {
+  // only the ids of this compile's errors are looked at
+  ErrorTable::clear();
+
+  if(auto error = check_script_size(*source)) return { nullptr, error };
+
+  std::shared_ptr<Program> program(new Program(source));
+
+  Lexer lexer(source);
+  TokenStream tokens(lexer);
+  // the program may be evaluated on this thread or any new one
+  max_depth = std::min(stack_depth_limit(max_depth), thread_depth_limit(max_depth));
+  Parser parser(tokens, program->arena, max_depth);
+  Result<ASTNode*> ast = parser.parse();
+
+  // a lexing error anywhere in the script wins over a syntax error, as in run()
+  if(!ast) tokens.drain();
+  if(tokens.get_error()) return { nullptr, ErrorTable::get(tokens.get_error()) };
+  if(!ast) return { nullptr, ast.get_error() };
+
+  ConstantFolder::fold(ast.value(), program->arena);
+
+  define_builtins(program->layout);
+  Resolver::resolve(ast.value(), program->layout);
+  program->root = ast.value();
+
+  // closures are the fastest backend whose compiled form is never written
+  // to while it runs (the tree walker quickens its nodes)
+  program->closure = ClosureCompiler::compile(ast.value(), program->arena);
+
+  return { std::move(program), nullptr };
+}
+
+std::optional<std::uint32_t> Program::slot_of(std::string_view name) const {
+  std::optional<std::uint32_t> id = find_symbol(name);
+  if(!id || is_builtin(*id)) return std::nullopt;
+
+  return layout.find(*id);
+}
+
+Bindings Program::bind() const {
+  return Bindings(layout);
+}
+
+RunType Program::evaluate(Bindings& bindings) const {
+  ErrorTable::clear();
+
+  ClosureFrame frame{ bindings.context, *bindings.context.symbol_table };
+  Result<Value> result = closure(frame);
+
+  if(!result) {
+    return { std::nullopt, result.get_error() };
+  } else if(result->is_none()) {
+    return { std::nullopt, nullptr };
+  }
+
+  return { Number(result->as_number()), nullptr };
+}
+
+// end program
+
+CompileResult compile(
+  const std::string& fn,
+  const std::string& text,
+  std::uint32_t max_depth
+) {
+  return Program::compile(SourceManager::instance().add(fn, text), max_depth);
+}
@@ -0,0 +1,89 @@
+#ifndef PROGRAM
+#define PROGRAM
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "arena.h"
+#include "context.h"
+#include "lexer.h"
+#include "parser.h"
+#include "closure/closure_compiler.h"
+#include "state/symbol_table.h"
+
+class Exception;
+class SourceFile;
+class Program;
+
+// the compiled program, or the error that stopped compiling it
+using CompileResult = std::pair<std::shared_ptr<const Program>, std::shared_ptr<Exception>>;
+
+// the variables one evaluation of a Program runs against. make them with
+// Program::bind and keep them for the next evaluation on the same thread:
+// only the inputs that change have to be set again. variables the script
+// assigns keep their values between evaluations too
+class Bindings {
+private:
+  Context context;
+
+  friend class Program;
+
+  Bindings(const SymbolTable& layout);
+
+public:
+  // slot must come from Program::slot_of of the program that made these
+  inline void set(std::uint32_t slot, double value) { context.symbol_table->store(slot, value); }
+  inline std::optional<double> get(std::uint32_t slot) const { return context.symbol_table->load(slot); }
+};
+
+// a script lexed, parsed, folded, resolved and compiled to closures once,
+// to be evaluated many times. it never changes after compile, so one
+// program can be shared by any number of threads, each evaluating with
+// its own Bindings
+class Program {
+private:
+  // keeps the positions errors point at readable
+  std::shared_ptr<const SourceFile> source;
+  AstArena arena;
+  // the folded and resolved tree the closures were compiled from
+  const ASTNode* root = nullptr;
+  Closure closure{};
+  // the slot of every variable the script names, builtins defined
+  SymbolTable layout;
+
+  Program(const std::shared_ptr<const SourceFile>& source): source(source) {}
+
+public:
+  static CompileResult compile(
+    const std::shared_ptr<const SourceFile>& source,
+    std::uint32_t max_depth = DEFAULT_MAX_DEPTH
+  );
+
+  Program(const Program&) = delete;
+  Program& operator=(const Program&) = delete;
+
+  // the slot input variable name binds to, nullopt if the script never
+  // mentions it
+  std::optional<std::uint32_t> slot_of(std::string_view name) const;
+
+  // fresh variables for this program: the builtins and nothing else defined
+  Bindings bind() const;
+
+  // runs the whole program, the result is the value of its last statement
+  RunType evaluate(Bindings& bindings) const;
+
+  // for backends that compile the program further (batch/)
+  inline const ASTNode* get_root() const { return root; }
+  inline const SymbolTable& get_layout() const { return layout; }
+};
+
+CompileResult compile(
+  const std::string& fn,
+  const std::string& text,
+  std::uint32_t max_depth = DEFAULT_MAX_DEPTH
+);
+
+#endif
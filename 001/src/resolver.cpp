@@ -0,0 +1,78 @@
+#include "resolver.h"
+
+void Resolver::resolve(ASTNode* program, SymbolTable& table) {
+  Resolver(table).resolve_node(program);
+}
+
+std::uint32_t Resolver::use(std::uint32_t name) {
+  std::uint32_t slot = table.resolve(name);
+  if(slot >= uses.size()) uses.resize(slot + 1, 0);
+  uses[slot]++;
+  return slot;
+}
+
+void Resolver::resolve_node(ASTNode* node) {
+  switch(node->kind) {
+    case NODE_NUMBER: break;
+
+    case NODE_VAR_ACCESS: {
+      auto* access = static_cast<VarAccessNode*>(node);
+      access->slot = use(access->var_name);
+      break;
+    }
+
+    case NODE_VAR_ASSIGN: {
+      auto* assign = static_cast<VarAssignNode*>(node);
+      assign->slot = use(assign->var_name);
+      resolve_node(assign->value_node);
+      break;
+    }
+
+    case NODE_BIN_OP: {
+      auto* bin_op = static_cast<BinOpNode*>(node);
+      resolve_node(bin_op->left_node);
+      resolve_node(bin_op->right_node);
+      break;
+    }
+
+    case NODE_UNARY_OP:
+      resolve_node(static_cast<UnaryOpNode*>(node)->node);
+      break;
+
+    case NODE_IF: {
+      auto* if_node = static_cast<IfNode*>(node);
+      for(const auto&[condition, expr] : if_node->cases) {
+        resolve_node(condition);
+        resolve_node(expr);
+      }
+      if(if_node->else_case) resolve_node(if_node->else_case);
+      break;
+    }
+
+    case NODE_FOR: {
+      auto* for_node = static_cast<ForNode*>(node);
+      for_node->slot = use(for_node->var_name);
+      resolve_node(for_node->start_value);
+      resolve_node(for_node->end_value);
+      if(for_node->step_value) resolve_node(for_node->step_value);
+
+      std::uint32_t before = uses[for_node->slot];
+      resolve_node(for_node->body);
+      for_node->var_in_body = uses[for_node->slot] != before;
+      break;
+    }
+
+    case NODE_WHILE: {
+      auto* while_node = static_cast<WhileNode*>(node);
+      resolve_node(while_node->condition);
+      resolve_node(while_node->body);
+      break;
+    }
+
+    case NODE_STATEMENTS:
+      for(ASTNode* statement : static_cast<StatementsNode*>(node)->statements) {
+        resolve_node(statement);
+      }
+      break;
+  }
+}
@@ -0,0 +1,27 @@
+#ifndef RESOLVER
+#define RESOLVER
+
+#include <cstdint>
+#include <vector>
+#include "nodes.h"
+#include "state/symbol_table.h"
+
+// runs once between parsing and evaluation: gives every variable node the
+// slot of its variable in table. all variables are globals for now, so
+// there is a single table to resolve against
+class Resolver {
+private:
+  SymbolTable& table;
+  // references to each slot seen so far
+  std::vector<std::uint32_t> uses{};
+
+  Resolver(SymbolTable& table): table(table) {}
+
+  std::uint32_t use(std::uint32_t name);
+  void resolve_node(ASTNode* node);
+
+public:
+  static void resolve(ASTNode* program, SymbolTable& table);
+};
+
+#endif
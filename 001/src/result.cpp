@@ -0,0 +1,18 @@
+#include "result.h"
+#include "exception.h"
+
+thread_local std::vector<std::shared_ptr<Exception>> ErrorTable::errors{};
+
+ErrorId ErrorTable::add(std::shared_ptr<Exception> error) {
+  errors.push_back(std::move(error));
+  return static_cast<ErrorId>(errors.size());
+}
+
+std::shared_ptr<Exception> ErrorTable::get(ErrorId id) {
+  if(id == NO_ERROR || id > errors.size()) return nullptr;
+  return errors[id - 1];
+}
+
+void ErrorTable::clear() {
+  errors.clear();
+}
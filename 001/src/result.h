@@ -0,0 +1,69 @@
+#ifndef RESULT
+#define RESULT
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class Exception;
+
+// handle of a raised error, NO_ERROR is 0
+enum ErrorId : std::uint32_t { NO_ERROR = 0 };
+
+// owns the exceptions behind ErrorIds. there is one table per thread, and
+// run() clears it before it starts, so an id is only good until then
+class ErrorTable {
+private:
+  static thread_local std::vector<std::shared_ptr<Exception>> errors;
+
+public:
+  static ErrorId add(std::shared_ptr<Exception> error);
+  static std::shared_ptr<Exception> get(ErrorId id);
+  static void clear();
+};
+
+struct Failure {
+  ErrorId id;
+};
+
+// records error and returns a failure any Result converts from
+inline Failure fail(std::shared_ptr<Exception> error) {
+  return { ErrorTable::add(std::move(error)) };
+}
+
+// either a T or the id of the error that stopped producing one, in the
+// spirit of std::expected. the success path carries no shared_ptr: for
+// small trivially copyable T (Value, ASTNode*) the whole result is two
+// words and comes back in registers
+template<typename T>
+class [[nodiscard]] Result {
+private:
+  T val{};
+  ErrorId err = NO_ERROR;
+
+public:
+  Result(const T& value): val(value) {}
+  Result(T&& value): val(std::move(value)) {}
+  Result(Failure failure): err(failure.id) {}
+
+  inline bool has_value() const { return err == NO_ERROR; }
+  inline explicit operator bool() const { return has_value(); }
+
+  inline T& value() & { return val; }
+  inline const T& value() const& { return val; }
+  inline T&& value() && { return std::move(val); }
+  inline const T& operator*() const { return val; }
+  inline const T* operator->() const { return &val; }
+
+  inline ErrorId error() const { return err; }
+  // the exception behind error(), nullptr on success
+  inline std::shared_ptr<Exception> get_error() const {
+    return has_value() ? nullptr : ErrorTable::get(err);
+  }
+
+  // passes this failure on as a result of another type
+  inline Failure failure() const { return { err }; }
+};
+
+#endif
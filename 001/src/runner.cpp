@@ -0,0 +1,130 @@
+#include "runner.h"
+#include "engine.h"
+#include "exception.h"
+#include "symbols.h"
+#include "state/interpreter.h"
+#include <algorithm>
+
+BatchRunner::BatchRunner(unsigned threads) {
+  if(threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+  for(unsigned i = 0; i < threads; i++) queues.push_back(std::make_unique<WorkQueue>());
+  for(unsigned i = 0; i < threads; i++) workers.emplace_back(&BatchRunner::work, this, i);
+}
+
+BatchRunner::~BatchRunner() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+
+  started.notify_all();
+  for(std::thread& worker : workers) worker.join();
+}
+
+// sets the variables job starts out with. a builtin cannot be one of them,
+// as a script cannot reassign one either
+static RunType bind(Engine& engine, const Job& job) {
+  for(const auto& [name, value] : job.bindings) {
+    if(is_builtin(intern(name))) {
+      return { std::nullopt, std::make_shared<Exception>(
+        Position(), Position(), "Runtime Error",
+        std::string("cannot reassign built-in variable '") + name + "'"
+      ) };
+    }
+
+    engine.get_globals().set(name, value);
+  }
+
+  return { std::nullopt, nullptr };
+}
+
+// the next job for worker: its own oldest, else the newest of another queue
+bool BatchRunner::take(std::size_t worker, std::size_t& job) {
+  {
+    WorkQueue& own = *queues[worker];
+    std::lock_guard<std::mutex> lock(own.mutex);
+
+    if(!own.jobs.empty()) {
+      job = own.jobs.front();
+      own.jobs.pop_front();
+      return true;
+    }
+  }
+
+  for(std::size_t i = 1; i < queues.size(); i++) {
+    WorkQueue& victim = *queues[(worker + i) % queues.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+
+    if(!victim.jobs.empty()) {
+      job = victim.jobs.back();
+      victim.jobs.pop_back();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void BatchRunner::work(std::size_t worker) {
+  Engine engine;
+  std::size_t seen = 0;
+
+  for(;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      started.wait(lock, [&]() { return stopping || generation != seen; });
+
+      if(stopping) return;
+      seen = generation;
+    }
+
+    std::size_t index;
+
+    while(take(worker, index)) {
+      const Job& job = jobs[index];
+
+      engine.reset();
+      results[index] = bind(engine, job);
+      if(!results[index].second) results[index] = engine.run(job.name, job.source);
+
+      if(remaining.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished.notify_all();
+      }
+    }
+  }
+}
+
+std::vector<RunType> BatchRunner::run(std::span<const Job> batch) {
+  std::lock_guard<std::mutex> turn(running);
+  std::vector<RunType> output(batch.size());
+
+  if(batch.empty()) return output;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs = batch;
+    results = output.data();
+    remaining = batch.size();
+  }
+
+  // only now are the jobs queued: a worker still looking for work from the
+  // last batch may take one as soon as it is, and must see the batch above.
+  // contiguous runs keep each worker on neighbouring jobs until it steals
+  for(std::size_t i = 0; i < queues.size(); i++) {
+    std::size_t begin = batch.size() * i / queues.size();
+    std::size_t end = batch.size() * (i + 1) / queues.size();
+
+    std::lock_guard<std::mutex> lock(queues[i]->mutex);
+    for(std::size_t job = begin; job < end; job++) queues[i]->jobs.push_back(job);
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  generation++;
+
+  started.notify_all();
+  finished.wait(lock, [&]() { return remaining == 0; });
+
+  return output;
+}
@@ -0,0 +1,75 @@
+#ifndef RUNNER
+#define RUNNER
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "lexer.h"
+
+// a script to run and the variables it starts out with. binding a builtin
+// (null, quit, true, false) fails the job without running it
+struct Job {
+  std::string name;
+  std::string source;
+  std::vector<std::pair<std::string, double>> bindings{};
+};
+
+// runs many independent scripts on a pool of threads. every worker owns
+// an Engine, reset before each job, so jobs never see each other's
+// variables and share no interpreter state.
+//
+// a batch of jobs is dealt out in contiguous runs, one queue per worker.
+// a worker takes its own jobs from the front, in submission order, and
+// once its queue is empty steals from the back of the others, so a few
+// slow scripts do not leave the remaining workers idle
+class BatchRunner {
+private:
+  // locked per queue: a job is a whole script, which dwarfs the lock
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<std::size_t> jobs;
+  };
+
+  std::vector<std::unique_ptr<WorkQueue>> queues;
+  std::vector<std::thread> workers;
+
+  // held by run() for the whole batch, so batches never overlap
+  std::mutex running;
+
+  // the batch being run, published under mutex
+  std::mutex mutex;
+  std::condition_variable started, finished;
+  std::span<const Job> jobs{};
+  RunType* results = nullptr;
+  std::size_t generation = 0;
+  bool stopping = false;
+  // jobs not finished yet
+  std::atomic<std::size_t> remaining = 0;
+
+  bool take(std::size_t worker, std::size_t& job);
+  void work(std::size_t worker);
+
+public:
+  // threads 0 means one per core
+  explicit BatchRunner(unsigned threads = 0);
+  ~BatchRunner();
+
+  BatchRunner(const BatchRunner&) = delete;
+  BatchRunner& operator=(const BatchRunner&) = delete;
+
+  inline std::size_t get_thread_count() const { return workers.size(); }
+
+  // runs every job and waits for all of them. results[i] is what run()
+  // would have returned for jobs[i]. calls from several threads take turns
+  std::vector<RunType> run(std::span<const Job> jobs);
+};
+
+#endif
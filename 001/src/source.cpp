@@ -0,0 +1,125 @@
+#include "source.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SOURCE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// source file
+
+SourceFile::SourceFile(std::uint32_t id, const std::string& fn, std::string text)
+  : id(id), fn(fn), storage(std::move(text)), text(storage) {}
+
+SourceFile::SourceFile(std::uint32_t id, const std::string& fn, void* mapping, std::size_t size)
+  : id(id), fn(fn), mapping(mapping), mapping_size(size),
+    text(static_cast<const char*>(mapping), size) {}
+
+SourceFile::~SourceFile() {
+#ifdef SOURCE_MMAP
+  if(mapping) munmap(mapping, mapping_size);
+#endif
+}
+
+void SourceFile::build_index() const {
+  line_starts.push_back(0);
+
+  for(std::size_t i = 0; i < text.size(); i++) {
+    if(text[i] == '\n') line_starts.push_back(i + 1);
+  }
+}
+
+std::int64_t SourceFile::line_of(std::int64_t idx) const {
+  std::call_once(index_flag, [this]() { build_index(); });
+
+  // last line start that is <= idx
+  auto it = std::upper_bound(line_starts.begin(), line_starts.end(), idx);
+  return std::max<std::int64_t>(0, (it - line_starts.begin()) - 1);
+}
+
+std::int64_t SourceFile::col_of(std::int64_t idx) const {
+  std::int64_t ln = line_of(idx);
+  return idx - line_starts[ln];
+}
+
+// end source file
+
+// source manager
+
+SourceManager& SourceManager::instance() {
+  static SourceManager manager;
+  return manager;
+}
+
+void SourceManager::Shard::sweep() {
+  // drop scripts nobody references anymore before the table grows further
+  if(files.size() >= sweep_at) {
+    std::erase_if(files, [](const auto& entry) { return entry.second.expired(); });
+    sweep_at = std::max<std::size_t>(64, files.size() * 2);
+  }
+}
+
+std::shared_ptr<const SourceFile> SourceManager::insert(std::shared_ptr<const SourceFile> file) {
+  Shard& shard = shards[file->get_id() % SHARDS];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  shard.sweep();
+  shard.files[file->get_id()] = file;
+
+  return file;
+}
+
+std::shared_ptr<const SourceFile> SourceManager::add(const std::string& fn, std::string text) {
+  return insert(std::make_shared<const SourceFile>(next_id++, fn, std::move(text)));
+}
+
+std::shared_ptr<const SourceFile> SourceManager::add_file(const std::string& path) {
+#ifdef SOURCE_MMAP
+  int fd = open(path.c_str(), O_RDONLY);
+  if(fd < 0) return nullptr;
+
+  struct stat st;
+  if(fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    close(fd);
+    return nullptr;
+  }
+
+  // mmap refuses empty files, those just get an empty owned buffer
+  if(st.st_size == 0) {
+    close(fd);
+    return add(path, "");
+  }
+
+  void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(mapping == MAP_FAILED) return nullptr;
+
+  // the lexer walks the script front to back exactly once
+  madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+
+  return insert(std::make_shared<const SourceFile>(next_id++, path, mapping, st.st_size));
+#else
+  std::ifstream file(path, std::ios::binary);
+  if(!file) return nullptr;
+
+  std::string text(std::istreambuf_iterator<char>(file), {});
+  return add(path, std::move(text));
+#endif
+}
+
+std::shared_ptr<const SourceFile> SourceManager::get(std::uint32_t id) const {
+  Shard& shard = shards[id % SHARDS];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  auto it = shard.files.find(id);
+  if(it == shard.files.end()) return nullptr;
+
+  return it->second.lock();
+}
+
+// end source manager
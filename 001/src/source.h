@@ -0,0 +1,78 @@
+#ifndef SOURCE
+#define SOURCE
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// a single script, held once and shared by every position that points into it.
+// the text is either owned or a read-only memory mapping of the script file
+class SourceFile {
+private:
+  std::uint32_t id;
+  std::string fn;
+  std::string storage;
+  void* mapping = nullptr;
+  std::size_t mapping_size = 0;
+  std::string_view text;
+
+  // byte offset of the first character of every line, built on first use
+  mutable std::once_flag index_flag;
+  mutable std::vector<std::int64_t> line_starts;
+
+  void build_index() const;
+
+public:
+  SourceFile(std::uint32_t id, const std::string& fn, std::string text);
+  // takes ownership of a region returned by mmap
+  SourceFile(std::uint32_t id, const std::string& fn, void* mapping, std::size_t size);
+  ~SourceFile();
+
+  SourceFile(const SourceFile&) = delete;
+  SourceFile& operator=(const SourceFile&) = delete;
+
+  inline std::uint32_t get_id() const { return id; }
+  inline const std::string& get_fn() const { return fn; }
+  inline std::string_view get_text() const { return text; }
+
+  std::int64_t line_of(std::int64_t idx) const;
+  std::int64_t col_of(std::int64_t idx) const;
+};
+
+// registry mapping file ids to scripts. entries are weak so a script lives
+// exactly as long as a lexer, exception or caller still holds it.
+// consecutive ids go to different shards, each behind a lock of its own,
+// so threads registering scripts at the same time rarely wait on each other
+class SourceManager {
+private:
+  static constexpr std::size_t SHARDS = 16;
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<std::uint32_t, std::weak_ptr<const SourceFile>> files{};
+    std::size_t sweep_at = 64;
+
+    void sweep();
+  };
+
+  mutable std::array<Shard, SHARDS> shards{};
+  std::atomic<std::uint32_t> next_id = 1;
+
+  std::shared_ptr<const SourceFile> insert(std::shared_ptr<const SourceFile> file);
+
+public:
+  static SourceManager& instance();
+
+  std::shared_ptr<const SourceFile> add(const std::string& fn, std::string text);
+  // maps the file at path into memory, nullptr if it cannot be opened
+  std::shared_ptr<const SourceFile> add_file(const std::string& path);
+  std::shared_ptr<const SourceFile> get(std::uint32_t id) const;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "stack_limit.h"
+#include <algorithm>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <pthread.h>
+#define HAVE_PTHREAD_STACK
+#endif
+
+static std::uint32_t depth_for(std::size_t bytes, std::uint32_t requested) {
+  if(bytes <= STACK_RESERVE) return 1;
+
+  std::size_t levels = (bytes - STACK_RESERVE) / STACK_BYTES_PER_LEVEL;
+  return static_cast<std::uint32_t>(std::clamp<std::size_t>(levels, 1, requested));
+}
+
+#ifdef HAVE_PTHREAD_STACK
+
+// lowest address of the calling thread's stack, nullptr where it cannot be
+// found out
+static char* find_stack_low() {
+#if defined(__APPLE__)
+  pthread_t self = pthread_self();
+  return static_cast<char*>(pthread_get_stackaddr_np(self)) - pthread_get_stacksize_np(self);
+#else
+  pthread_attr_t attr;
+  if(pthread_getattr_np(pthread_self(), &attr) != 0) return nullptr;
+
+  void* address;
+  std::size_t size;
+  char* low = nullptr;
+  if(pthread_attr_getstack(&attr, &address, &size) == 0) low = static_cast<char*>(address);
+  pthread_attr_destroy(&attr);
+
+  return low;
+#endif
+}
+
+#endif
+
+std::uint32_t stack_depth_limit(std::uint32_t requested) {
+#ifdef HAVE_PTHREAD_STACK
+  // looked up once per thread, for the main thread glibc reads
+  // /proc/self/maps to find it
+  thread_local char* low = find_stack_low();
+
+  // the stack grows down on every platform handled here, so what is left
+  // lies between this frame and the lowest address of the stack
+  char here;
+
+  if(!low || &here <= low) return requested;
+  return depth_for(static_cast<std::size_t>(&here - low), requested);
+#else
+  return requested;
+#endif
+}
+
+std::uint32_t thread_depth_limit(std::uint32_t requested) {
+#ifdef HAVE_PTHREAD_STACK
+  // std::thread creates its threads with the default attributes
+  pthread_attr_t attr;
+  if(pthread_attr_init(&attr) != 0) return requested;
+
+  std::size_t size = 0;
+  int error = pthread_attr_getstacksize(&attr, &size);
+  pthread_attr_destroy(&attr);
+
+  if(error != 0 || size == 0) return requested;
+  return depth_for(size, requested);
+#else
+  return requested;
+#endif
+}
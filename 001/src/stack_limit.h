@@ -0,0 +1,23 @@
+#ifndef STACK_LIMIT
+#define STACK_LIMIT
+
+#include <cstddef>
+#include <cstdint>
+
+// stack a single level of nesting may take in the deepest pass over the
+// tree. measured at about 750 bytes for the parser in an optimised build,
+// the rest is margin for other compilers and sanitizers
+constexpr std::size_t STACK_BYTES_PER_LEVEL = 2048;
+
+// kept free below the deepest level, for the calls made from there
+constexpr std::size_t STACK_RESERVE = 64 * 1024;
+
+// requested, lowered to the depth the stack left to the calling thread can
+// take. unchanged where the stack bounds cannot be found out
+std::uint32_t stack_depth_limit(std::uint32_t requested);
+
+// the same for the stack a new std::thread gets, for trees that are
+// evaluated on threads other than the one that parsed them
+std::uint32_t thread_depth_limit(std::uint32_t requested);
+
+#endif
@@ -2,37 +2,12 @@
 #include "../exception.h"
 #include "../position.h"
 #include "../lexer.h"
-#include <iostream>
+#include "../symbols.h"
 #include <optional>
-#include <sstream>
+#include <charconv>
 #include <stdexcept>
 #include <cmath>
-
-Number RTResult::register_(const RTResult& res) {
-  if(res.error) this->error = res.error;
-  if(res.value)
-    //return res.value.value();
-    return std::visit([&](const auto& val) -> Number {
-      if constexpr (std::is_same_v<std::decay_t<decltype(val)>, Number>) {
-        return val;
-      } else {
-        throw std::runtime_error("unsupported in register_()");
-      }
-    }, res.value.value());
-
-  return Number(-1);
-}
-
-RTResult& RTResult::success(const std::optional<RTVariant>& value) {
-  this->value = value;
-  return *this;
-}
-
-RTResult& RTResult::failure(const std::shared_ptr<Exception>& error) {
-  this->error = std::move(error);
-  this->value = std::nullopt;
-  return *this;
-}
+#include <algorithm>
 
 Number::Number(double value): value(value) {
   set_pos();
@@ -60,438 +35,290 @@ Number Number::copy() {
     .set_context(context);
 }
 
-NumberPair Number::added_to(const Number& other) const {
-  return { 
-    Number(this->value + other.value).set_context(this->context), nullptr };
+bool Number::is_true() const {
+  return value != 0;
 }
 
-NumberPair Number::subbed_by(const Number& other) const {
-  return { Number(this->value - other.value).set_context(this->context), nullptr };
+std::string Number::as_string() const {
+  char buffer[32];
+  return std::string(buffer, format_number(buffer, buffer + sizeof(buffer), value));
 }
 
-NumberPair Number::multiplied_by(const Number& other) const {
-  return { Number(this->value * other.value).set_context(this->context), nullptr };
+char* format_number(char* first, char* last, double value) {
+  return std::to_chars(first, last, value, std::chars_format::general, 6).ptr;
 }
 
-NumberPair Number::divided_by(const Number& other) const {
-  if(other.value == 0) {
-    return { std::nullopt, std::make_shared<RTException>(
-      other.context,
-      other.pos_start.value(), other.pos_end.value(),
-      "division by zero"
-      ) };
-  }
+bool is_builtin(std::uint32_t id) {
+  static const std::vector<std::uint32_t> ids = [] {
+    std::vector<std::uint32_t> result;
+    for(const std::string& name : builtins) result.push_back(intern(name));
+    return result;
+  }();
 
-  return { Number(this->value / other.value).set_context(this->context), nullptr };
+  return std::ranges::find(ids, id) != ids.end();
 }
 
-NumberPair Number::powed_by(const Number& other) const {
-  return { 
-    Number(std::pow(this->value, other.value)).set_context(this->context),
-    nullptr 
-  };
+void define_builtins(SymbolTable& table) {
+  table.set("null", -1);
+  table.set("quit", 0);
+  table.set("true", 1);
+  table.set("false", 0);
 }
 
-NumberPair Number::modded_by(const Number& other) const {
-  if(other.value == 0) {
-    return { std::nullopt, std::make_shared<RTException>(
-      other.context,
-      other.pos_start.value(), other.pos_end.value(),
-      "modulus by zero"
-    ) };
-  }
+// visit methods
 
-  return { 
-    Number(std::fmod(this->value, other.value)).set_context(this->context), 
-    nullptr
-  };
+Result<Value> Interpreter::visit(ASTNode* node, Context& context) const {
+  return node->accept(*this, context);
 }
 
-NumberPair Number::eq_comp(const Number& other) const {
-  return {
-    Number(static_cast<int>(value == other.value))
-      .set_context(context),
-    nullptr
-  };
+Failure Interpreter::failure(
+  const ASTNode* node,
+  Context& context,
+  const std::string& details
+) const {
+  return fail(std::make_shared<RTException>(
+    context, node->get_pos_start(), node->get_pos_end(), details
+  ));
 }
 
-NumberPair Number::ne_comp(const Number& other) const {
-  return {
-    Number(static_cast<int>(value != other.value))
-      .set_context(context),
-    nullptr
-  };
+void Interpreter::note_branch(const ASTNode* expr) const {
+  // an if branch that is an if itself has already noted its own branch
+  const ASTNode* origin = value_origin(expr);
+  if(origin->kind != NODE_IF) branch_origin = origin;
 }
 
-NumberPair Number::lt_comp(const Number& other) const {
-  return {
-    Number(static_cast<int>(value < other.value))
-      .set_context(context),
-    nullptr
-  };
+const ASTNode* Interpreter::divisor_origin(const ASTNode* divisor) const {
+  const ASTNode* origin = value_origin(divisor);
+  return (origin->kind == NODE_IF) ? branch_origin : origin;
 }
 
-NumberPair Number::gt_comp(const Number& other) const {
-  return {
-    Number(static_cast<int>(value > other.value))
-      .set_context(context),
-    nullptr
-  };
-}
+Result<Value> Interpreter::visit_VarAccessNode(const VarAccessNode& node, Context& context) const {
+  std::optional<double> value = context.symbol_table->load(node.slot);
 
-NumberPair Number::lte_comp(const Number& other) const {
-  return {
-    Number(static_cast<int>(value <= other.value))
-      .set_context(context),
-    nullptr
-  };
-}
+  if(!value) {
+    return failure(&node, context, std::string("'") + std::string(symbol_name(node.var_name)) + "' is not defined");
+  }
 
-NumberPair Number::gte_comp(const Number& other) const {
-  return {
-    Number(static_cast<int>(value >= other.value))
-      .set_context(context),
-    nullptr
-  };
+  return Value::number(value.value());
 }
 
-NumberPair Number::and_comp(const Number& other) const {
-  return {
-    Number(static_cast<int>(value && other.value))
-      .set_context(context),
-    nullptr
-  };
-}
+Result<Value> Interpreter::visit_VarAssignNode(const VarAssignNode& node, Context& context) const {
+  Result<Value> value = visit(node.value_node, context);
+  if(!value) return value;
 
-NumberPair Number::or_comp(const Number& other) const {
-  return {
-    Number(static_cast<int>(value || other.value))
-      .set_context(context),
-    nullptr
-  };
-}
+  if(is_builtin(node.var_name)) {
+    return failure(
+      &node, context,
+      std::string("cannot reassign built-in variable '") + std::string(symbol_name(node.var_name)) + "'"
+    );
+  }
 
-NumberPair Number::not_operator() const {
-  return {
-    Number(
-      (value == 0) ? 1 : 0
-    ).set_context(context),
-    nullptr
-  };
-}
+  if(value->is_none()) {
+    return failure(&node, context, std::string("'") + std::string(symbol_name(node.var_name)) + "' is not defined");
+  }
 
-bool Number::is_true() const {
-  return value != 0;
+  context.symbol_table->store(node.slot, value->as_number());
+  return value;
 }
 
-std::string Number::as_string() const {
-  std::ostringstream oss;
-  oss << value;
-  return oss.str();
+Result<Value> Interpreter::visit_NumberNode(const NumberNode& node, Context&) const {
+  return Value::number(node.value);
 }
 
-// visit methods
-
-RTResult Interpreter::visit(const std::shared_ptr<ASTNode>& node, Context& context) const {
-  return node->accept(*this, context);
-}
+// reads an operand the way its mode says. a variable that turns out not to
+// be defined sends the operand back to a generic visit for good, which
+// raises the usual error
+Result<Value> Interpreter::operand(ASTNode* node, OperandMode& mode, Context& context) const {
+  if(mode == OPERAND_CONST) {
+    return Value::number(static_cast<NumberNode*>(node)->value);
+  }
 
-RTResult Interpreter::visit_VarAccessNode(const VarAccessNode& node, Context& context) const {
-  RTResult res;
-  std::string var_name = std::get<std::string>(node.var_name_tok.value.value());
-  std::optional<TokenValue> value;
+  if(mode == OPERAND_SLOT) {
+    std::optional<double> value = context.symbol_table->load(static_cast<VarAccessNode*>(node)->slot);
+    if(value) return Value::number(value.value());
 
-  try {
-    value = context.symbol_table->get(var_name);
-  } catch (std::out_of_range&) {
-    value = std::nullopt;
+    mode = OPERAND_NODE;
+    stats.deoptimized++;
   }
 
-  if(!value) {
-    return res.failure(std::make_shared<RTException>(
-      context,
-      node.pos_start, node.pos_end,
-      "'" + var_name + "' is not defined"
-    ));
-  }
+  return visit(node, context);
+}
 
-  return std::visit([&](const auto& val) -> RTResult {
-    using T = std::decay_t<decltype(val)>;
+// called once a node has run through: from then on its number and
+// variable operands are read in place
+void Interpreter::quicken(BinOpNode& node) const {
+  auto mode_of = [&](const ASTNode* operand) {
+    if(!quickening) return OPERAND_NODE;
 
-    if constexpr (std::is_same_v<T, int>) {
-      return res.success(
-        Number(static_cast<double>(val))
-        .set_context(context)
-        .set_pos(node.pos_start, node.pos_end)
-      );
-    } else if constexpr (std::is_same_v<T, double>) {
-      return res.success(
-        Number(val)
-        .set_context(context)
-        .set_pos(node.pos_start, node.pos_end)
-      );
-    } else if constexpr (std::is_same_v<T, std::shared_ptr<Number>>) {
-      return res.success(
-        Number(std::get<double>(val->get_value()))
-        .set_context(context)
-        .set_pos(node.pos_start, node.pos_end)
-      );
-    } else {
-      throw std::runtime_error("visit_VarAccessNode");
+    switch(operand->kind) {
+      case NODE_NUMBER: stats.quickened++; return OPERAND_CONST;
+      case NODE_VAR_ACCESS: stats.quickened++; return OPERAND_SLOT;
+      default: return OPERAND_NODE;
     }
-  }, value.value());
-}
+  };
 
-RTResult Interpreter::visit_VarAssignNode(const VarAssignNode& node, Context& context) const {
-  RTResult res;
+  node.left_mode = mode_of(node.left_node);
+  node.right_mode = mode_of(node.right_node);
+}
 
-  TokenValue tok_val = node.var_name_tok.value.value();
-  std::string var_name = std::get<std::string>(tok_val);
+template<BinaryOp OP>
+Result<Value> Interpreter::visit_BinOpNode(BinOpNode& node, Context& context) const {
+  Result<Value> left_value = operand(node.left_node, node.left_mode, context);
+  if(!left_value) return left_value;
 
-  RTResult value_expr = visit(node.value_node, context);
-  Number value = res.register_(value_expr);
+  // and/or leave the right side alone once the left decides the result
+  if constexpr(OP == BIN_AND || OP == BIN_OR) {
+    if(left_value->is_true() == (OP == BIN_OR)) return Value::number(OP == BIN_OR);
+  }
 
+  Result<Value> right_value = operand(node.right_node, node.right_mode, context);
+  if(!right_value) return right_value;
 
-  if(res.error) return res;
+  double right = right_value->as_number();
 
-  if(std::ranges::find(builtins, var_name) != builtins.end()) {
-    return res.failure(std::make_shared<RTException>(
-      context,
-      node.pos_start, node.pos_end,
-      "cannot reassign built-in variable '" + var_name + "'"
-    ));
+  if constexpr(OP == BIN_DIV || OP == BIN_MOD) {
+    if(right == 0) {
+      return failure(
+        divisor_origin(node.right_node), context,
+        (OP == BIN_DIV) ? "division by zero" : "modulus by zero"
+      );
+    }
   }
 
-  if(!value_expr.value) {
-    return res.failure(std::make_shared<RTException>(
-      context,
-      node.pos_start, node.pos_end,
-      "'" + var_name + "' is not defined"
-    ));
-  }
-  // std::cout << "setting " << var_name << " to value " << value.get_value();
+  if(node.left_mode == OPERAND_UNSEEN) quicken(node);
 
-  context.symbol_table->set(var_name, std::get<double>(value.get_value()));
-  return res.success(value);
+  return Value::number(apply_binary<OP>(left_value->as_number(), right));
 }
 
-RTResult Interpreter::visit_NumberNode(const NumberNode& node, Context& context) const {
-  Token node_value = node.tok.value();
-  TokenValue value = node_value.value.value();
+template<UnaryOp OP>
+Result<Value> Interpreter::visit_UnaryOpNode(const UnaryOpNode& node, Context& context) const {
+  Result<Value> value = visit(node.node, context);
+  if(!value) return value;
 
-  if(std::holds_alternative<int>(value)) {
-    return RTResult().success(
-      Number(std::get<int>(value)).set_context(context).set_pos(
-        node_value.pos_start.value(),
-        node_value.pos_end.value()
-      )
-    );
+  // '+' keeps the value as it is, only checking that it is defined
+  if constexpr(OP == UN_PLUS) {
+    return value->defined();
   } else {
-    return RTResult().success(
-      Number(std::get<double>(value)).set_context(context).set_pos(
-        node_value.pos_start.value(),
-        node_value.pos_end.value()
-      )
-    );
+    return Value::number(apply_unary<OP>(value->as_number()));
   }
 }
 
-RTResult Interpreter::visit_BinOpNode(const BinOpNode& node, Context& context) const {
-  RTResult res;
-  Number left = res.register_(visit(node.left_node, context));
-  if(res.error) return res;
-
-  Number right = res.register_(visit(node.right_node, context));
-  if(res.error) return res;
-
-  std::optional<Number> result;
-  std::shared_ptr<Exception> error;
-
-  if(node.op_tok.type == PLS_T) {
-    const auto&[res, err] = left.added_to(right);
-    result = res;
-    error = err;
-
-  } else if(node.op_tok.type == MIN_T) {
-    const auto&[res, err] = left.subbed_by(right);
-    result = res;
-    error = err;
-
-  } else if(node.op_tok.type == MUL_T) {
-    const auto&[res, err] = left.multiplied_by(right);
-    result = res;
-    error = err;
-
-  } else if(node.op_tok.type == DIV_T) {
-    const auto&[res, err] = left.divided_by(right);
-    result = res;
-    error = err;
-
-  } else if(node.op_tok.type == POW_T) {
-    const auto&[res, err] = left.powed_by(right);
-    result = res;
-    error = err;
-
-  } else if(node.op_tok.type == MOD_T) {
-    const auto&[res,err] = left.modded_by(right);
-    result = res;
-    error = err;
-
-  } else if(node.op_tok.type == EE_T) {
-    const auto&[res, err] = left.eq_comp(right);
-    result = res;
-    error = err;
-
-  } else if(node.op_tok.type == NE_T) {
-    const auto&[res, err] = left.ne_comp(right);
-    result = res;
-    error = err;
-
-  } else if(node.op_tok.type == LT_T) {
-    const auto&[res, err] = left.lt_comp(right);
-    result = res;
-    error = err;
-
-  } else if(node.op_tok.type == GT_T) {
-    const auto&[res, err] = left.gt_comp(right);
-    result = res;
-    error = err;
-
-  } else if(node.op_tok.type == LTE_T) {
-    const auto&[res, err] = left.lte_comp(right);
-    result = res;
-    error = err;
-
-  } else if(node.op_tok.type == GTE_T) {
-    const auto&[res, err] = left.gte_comp(right);
-    result = res;
-    error = err;
-
-  } else if(node.op_tok.matches(KWD_T, "and")) {
-    const auto&[res, err] = left.and_comp(right);
-    result = res;
-    error = err;
-
-  } else if(node.op_tok.matches(KWD_T, "or")) {
-    const auto&[res, err] = left.or_comp(right);
-    result = res;
-    error = err;
+#define INSTANTIATE_BINARY(op) \
+  template Result<Value> Interpreter::visit_BinOpNode<op>(BinOpNode&, Context&) const;
 
-  }
+INSTANTIATE_BINARY(BIN_ADD)
+INSTANTIATE_BINARY(BIN_SUB)
+INSTANTIATE_BINARY(BIN_MUL)
+INSTANTIATE_BINARY(BIN_DIV)
+INSTANTIATE_BINARY(BIN_POW)
+INSTANTIATE_BINARY(BIN_MOD)
+INSTANTIATE_BINARY(BIN_EE)
+INSTANTIATE_BINARY(BIN_NE)
+INSTANTIATE_BINARY(BIN_LT)
+INSTANTIATE_BINARY(BIN_GT)
+INSTANTIATE_BINARY(BIN_LTE)
+INSTANTIATE_BINARY(BIN_GTE)
+INSTANTIATE_BINARY(BIN_AND)
+INSTANTIATE_BINARY(BIN_OR)
 
-  if(error && !result.has_value())
-    return res.failure(error);
+#undef INSTANTIATE_BINARY
 
-  Number result_pos = result.value();
-  result_pos.set_pos(node.pos_start.value(), node.pos_end.value());
-  return res.success(result_pos);
-}
-
-RTResult Interpreter::visit_UnaryOpNode(const UnaryOpNode& node, Context& context) const {
-  RTResult res;
-  Number number = res.register_(visit(node.node, context));
-  if(res.error) return res;
+template Result<Value> Interpreter::visit_UnaryOpNode<UN_PLUS>(const UnaryOpNode&, Context&) const;
+template Result<Value> Interpreter::visit_UnaryOpNode<UN_MINUS>(const UnaryOpNode&, Context&) const;
+template Result<Value> Interpreter::visit_UnaryOpNode<UN_NOT>(const UnaryOpNode&, Context&) const;
 
-  std::shared_ptr<Exception> err;
+Result<Value> Interpreter::visit_IfNode(const IfNode& node, Context& context) const {
+  for(const auto&[condition, expr] : node.cases) {
+    Result<Value> condition_value = visit(condition, context);
+    if(!condition_value) return condition_value;
 
-  if(node.op_tok.type == MIN_T) {
-    const auto&[result, error] = number.multiplied_by(Number(-1));
+    if(condition_value->is_true()) {
+      Result<Value> expr_value = visit(expr, context);
+      if(!expr_value) return expr_value;
 
-    number = result.value();
-    err = error;
+      note_branch(expr);
+      return expr_value->defined();
+    }
+  }
 
-  } else if(node.op_tok.matches(KWD_T, "not")) {
-    const auto&[result, error] = number.not_operator();
+  if(node.else_case) {
+    Result<Value> else_value = visit(node.else_case, context);
+    if(!else_value) return else_value;
 
-    number = result.value();
-    err = error;
+    note_branch(node.else_case);
+    return else_value->defined();
   }
 
-  if(err) return res.failure(err);
-  
-  return res.success(number.set_pos(node.pos_start, node.pos_end));
+  return Value::none();
 }
 
-RTResult Interpreter::visit_IfNode(const IfNode& node, Context& context) const {
-  RTResult res;
+Result<Value> Interpreter::visit_ForNode(const ForNode& node, Context& context) const {
+  Result<Value> start_value = visit(node.start_value, context);
+  if(!start_value) return start_value;
 
-  for(const auto&[condition, expr] : node.cases) {
-    Number condition_value = res.register_(visit(condition, context));
-    if(res.error) return res;
+  Result<Value> end_value = visit(node.end_value, context);
+  if(!end_value) return end_value;
 
-    if(condition_value.is_true()) {
-      Number expr_value = res.register_(visit(expr, context));
-      if(res.error) return res;
+  double step = 1;
 
-      return res.success(expr_value);
-    }
-  }
+  if(node.step_value) {
+    Result<Value> step_value = visit(node.step_value, context);
+    if(!step_value) return step_value;
 
-  if(node.else_case) {
-    Number else_value = res.register_(visit(node.else_case, context));
-    if(res.error) return res;
-    return res.success(else_value);
+    step = step_value->as_number();
   }
 
-  return res.success(std::nullopt);
-}
+  double i = start_value->as_number();
+  double end = end_value->as_number();
+  bool up = step >= 0;
 
-RTResult Interpreter::visit_ForNode(const ForNode& node, Context& context) const {
-  RTResult res;
+  if(!(up ? i < end : i > end)) return Value::none();
 
-  Number start_value = res.register_(visit(node.start_value, context));
-  if(res.error) return res;
+  SymbolTable& symbols = *context.symbol_table;
 
-  Number end_value = res.register_(visit(node.end_value, context));
-  if(res.error) return res;
+  // i is the value of the current iteration. a body that cannot see the
+  // variable leaves it to be stored once, when the loop stops
+  for(;;) {
+    if(node.var_in_body) symbols.store(node.slot, i);
 
-  Number step_value(-1);
+    Result<Value> body = visit(node.body, context);
+    if(!body) {
+      if(!node.var_in_body) symbols.store(node.slot, i);
+      return body;
+    }
 
-  if(node.step_value) {
-    step_value = res.register_(visit(node.step_value, context));
-    if(res.error) return res;
-  } else {
-    step_value = 1;
+    double next = i + step;
+    if(!(up ? next < end : next > end)) break;
+    i = next;
   }
 
-  double i = std::get<double>(start_value.get_value());
-
-  std::function<bool()> condition;
+  if(!node.var_in_body) symbols.store(node.slot, i);
 
-  if(std::get<double>(step_value.get_value()) >= 0) {
-    condition = [&]() -> bool { return i < std::get<double>(end_value.get_value()); };
-  } else {
-    condition = [&]() -> bool { return i > std::get<double>(end_value.get_value()); };
-  }
-
-  while(condition()) {
-    context.symbol_table->set(
-      std::get<std::string>(node.var_name_tok.value.value()),
-      std::make_shared<Number>(i)
-    );
+  return Value::none();
+}
 
-    i += std::get<double>(step_value.get_value());
+Result<Value> Interpreter::visit_WhileNode(const WhileNode& node, Context& context) const {
+  while(true) {
+    Result<Value> condition = visit(node.condition, context);
+    if(!condition) return condition;
 
-    res.register_(visit(node.body, context));
-    if(res.error) return res;
+    if(!condition->is_true()) break;
 
+    Result<Value> body = visit(node.body, context);
+    if(!body) return body;
   }
 
-  return res.success(std::nullopt);
+  return Value::none();
 }
 
-RTResult Interpreter::visit_WhileNode(const WhileNode& node, Context& context) const {
-  RTResult res;
-
-  while(true) {
-    Number condition = res.register_(visit(node.condition, context));
-    if(res.error) return res;
+Result<Value> Interpreter::visit_StatementsNode(const StatementsNode& node, Context& context) const {
+  // the program evaluates to its last statement
+  Result<Value> res = Value::none();
 
-    if(!condition.is_true()) break;
-
-    res.register_(visit(node.body, context));
-    if(res.error) return res;
+  for(const auto& statement : node.statements) {
+    res = visit(statement, context);
+    if(!res) return res;
   }
 
-  return res.success(std::nullopt);
-}
\ No newline at end of file
+  return res;
+}
@@ -5,9 +5,12 @@
 #include "../nodes.h"
 #include "../position.h"
 #include "../exception.h"
+#include "../result.h"
+#include "value.h"
+#include <cmath>
+#include <cstdint>
 #include <functional>
-
-class Number;
+#include <variant>
 
 const std::vector<std::string> builtins = {
   "null",
@@ -16,11 +19,13 @@ const std::vector<std::string> builtins = {
   "false"
 };
 
-using NumberPair = std::pair<
-  std::optional<Number>,
-  std::shared_ptr<Exception>
->;
+// whether the interned symbol id names one of builtins
+bool is_builtin(std::uint32_t id);
+
+// gives the builtins their values in table
+void define_builtins(SymbolTable& table);
 
+// a finished result as run() hands it out. evaluation itself works on Value
 class Number {
 protected:
   double value;
@@ -36,26 +41,9 @@ public:
     const std::optional<Position>& pos_end = std::nullopt
   );
   Number& set_context(const std::optional<Context>& context = std::nullopt);
-  inline TokenValue get_value() const { return value; };
+  inline double get_value() const { return value; };
   Number copy();
 
-  // operations
-  NumberPair added_to(const Number& other) const;
-  NumberPair subbed_by(const Number& other) const;
-  NumberPair multiplied_by(const Number& other) const;
-  NumberPair divided_by(const Number& other) const;
-  NumberPair powed_by(const Number& other) const;
-  NumberPair modded_by(const Number& other) const;
-  NumberPair eq_comp(const Number& other) const;
-  NumberPair ne_comp(const Number& other) const;
-  NumberPair lt_comp(const Number& other) const;
-  NumberPair gt_comp(const Number& other) const;
-  NumberPair lte_comp(const Number& other) const;
-  NumberPair gte_comp(const Number& other) const;
-  NumberPair and_comp(const Number& other) const;
-  NumberPair or_comp(const Number& other) const;
-  NumberPair not_operator() const;
-
   bool is_true() const;
 
   std::string as_string() const;
@@ -63,28 +51,83 @@ public:
 
 using RTVariant = std::variant<Number, int, double, std::string>;
 
-class RTResult {
-public:
-  std::optional<RTVariant> value = std::nullopt;
-  std::shared_ptr<Exception> error = nullptr;
-
-  Number register_(const RTResult& res);
-  RTResult& success(const std::optional<RTVariant>& value);
-  RTResult& failure(const std::shared_ptr<Exception>& error);
+// called with the value of every top level statement as it completes
+using StatementSink = std::function<void(const RTVariant&)>;
+
+// what a binary operator computes, shared by every backend and the
+// folder. division and modulus by zero are checked by the caller
+template<BinaryOp OP>
+inline double apply_binary(double left, double right) {
+  if constexpr(OP == BIN_ADD) return left + right;
+  if constexpr(OP == BIN_SUB) return left - right;
+  if constexpr(OP == BIN_MUL) return left * right;
+  if constexpr(OP == BIN_DIV) return left / right;
+  if constexpr(OP == BIN_POW) return std::pow(left, right);
+  if constexpr(OP == BIN_MOD) return std::fmod(left, right);
+  if constexpr(OP == BIN_EE)  return left == right;
+  if constexpr(OP == BIN_NE)  return left != right;
+  if constexpr(OP == BIN_LT)  return left < right;
+  if constexpr(OP == BIN_GT)  return left > right;
+  if constexpr(OP == BIN_LTE) return left <= right;
+  if constexpr(OP == BIN_GTE) return left >= right;
+  if constexpr(OP == BIN_AND) return left && right;
+  if constexpr(OP == BIN_OR)  return left || right;
+}
+
+// what a unary operator computes, shared the same way
+template<UnaryOp OP>
+inline double apply_unary(double value) {
+  // a multiplication, not a negation, so nan keeps its sign
+  if constexpr(OP == UN_MINUS) return value * -1;
+  if constexpr(OP == UN_NOT)   return (value == 0) ? 1 : 0;
+  if constexpr(OP == UN_PLUS)  return value;
+}
+
+// writes value the way an ostream with default precision would ("%g"),
+// returns one past the last character written. 32 bytes is always enough
+char* format_number(char* first, char* last, double value);
+
+// what quickening did over an interpreter's lifetime: operands of
+// BinOpNodes it now reads in place, and how many of those it had to turn
+// back into a generic visit because their variable was not defined
+struct QuickenStats {
+  std::size_t quickened = 0;
+  std::size_t deoptimized = 0;
 };
 
 class Interpreter {
+private:
+  bool quickening;
+  mutable QuickenStats stats{};
+
+  // the node the value of the last finished if came from. division by zero
+  // blames it when the divisor was an if
+  mutable const ASTNode* branch_origin = nullptr;
+
+  Failure failure(const ASTNode* node, Context& context, const std::string& details) const;
+  void note_branch(const ASTNode* expr) const;
+  const ASTNode* divisor_origin(const ASTNode* divisor) const;
+
+  Result<Value> operand(ASTNode* node, OperandMode& mode, Context& context) const;
+  void quicken(BinOpNode& node) const;
+
 public:
+  explicit Interpreter(bool quickening = true): quickening(quickening) {}
+
+  inline const QuickenStats& get_quicken_stats() const { return stats; }
+
   // visitors
-  RTResult visit(const std::shared_ptr<ASTNode>& node, Context& context) const;
-  RTResult visit_NumberNode(const NumberNode& node, Context& context) const;
-  RTResult visit_BinOpNode(const BinOpNode& node, Context& context) const;
-  RTResult visit_UnaryOpNode(const UnaryOpNode& node, Context& context) const;
-  RTResult visit_VarAccessNode(const VarAccessNode& node, Context& context) const;
-  RTResult visit_VarAssignNode(const VarAssignNode& node, Context& context) const;
-  RTResult visit_IfNode(const IfNode& node, Context& context) const;
-  RTResult visit_ForNode(const ForNode& node, Context& context) const;
-  RTResult visit_WhileNode(const WhileNode& node, Context& context) const;
+  Result<Value> visit(ASTNode* node, Context& context) const;
+  Result<Value> visit_NumberNode(const NumberNode& node, Context& context) const;
+  // one instance per operator, instantiated in interpreter.cpp
+  template<BinaryOp OP> Result<Value> visit_BinOpNode(BinOpNode& node, Context& context) const;
+  template<UnaryOp OP> Result<Value> visit_UnaryOpNode(const UnaryOpNode& node, Context& context) const;
+  Result<Value> visit_VarAccessNode(const VarAccessNode& node, Context& context) const;
+  Result<Value> visit_VarAssignNode(const VarAssignNode& node, Context& context) const;
+  Result<Value> visit_IfNode(const IfNode& node, Context& context) const;
+  Result<Value> visit_ForNode(const ForNode& node, Context& context) const;
+  Result<Value> visit_WhileNode(const WhileNode& node, Context& context) const;
+  Result<Value> visit_StatementsNode(const StatementsNode& node, Context& context) const;
 };
 
 
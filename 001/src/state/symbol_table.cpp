@@ -1,26 +1,60 @@
 #include "symbol_table.h"
+#include "../symbols.h"
 #include <optional>
 
-std::optional<TokenValue> SymbolTable::get(const std::string& name) const {
-  std::optional<TokenValue> value = std::nullopt;
+std::uint32_t SymbolTable::resolve(std::uint32_t id) {
+  auto [it, inserted] = slot_ids.try_emplace(id, slots.size());
 
-  try {
-    value = symbols.at(name);
-  } catch (const std::out_of_range&) {
-    value = std::nullopt;
+  if(inserted) {
+    slots.push_back({ 0, false });
+    names.push_back(id);
   }
 
-  if(!value && parent) {
-    return parent->get(name);
-  }
+  return it->second;
+}
+
+std::optional<std::uint32_t> SymbolTable::find(std::uint32_t id) const {
+  auto it = slot_ids.find(id);
+  if(it == slot_ids.end()) return std::nullopt;
+
+  return it->second;
+}
+
+std::optional<double> SymbolTable::get(std::uint32_t id) const {
+  auto it = slot_ids.find(id);
+
+  if(it != slot_ids.end() && slots[it->second].defined) return slots[it->second].value;
+  if(parent) return parent->get(id);
+
+  return std::nullopt;
+}
+
+std::optional<double> SymbolTable::get(std::string_view name) const {
+  // a name the interner has never seen cannot have a slot
+  std::optional<std::uint32_t> id = find_symbol(name);
+  return id ? get(*id) : std::nullopt;
+}
+
+void SymbolTable::remove(std::uint32_t id) {
+  // the slot stays, nodes resolved to it may still run
+  auto it = slot_ids.find(id);
+  if(it != slot_ids.end()) slots[it->second].defined = false;
+}
+
+void SymbolTable::remove(std::string_view name) {
+  if(std::optional<std::uint32_t> id = find_symbol(name)) remove(*id);
+}
 
-  return value;
+void SymbolTable::set(std::uint32_t id, double value) {
+  store(resolve(id), value);
 }
 
-void SymbolTable::remove(const std::string& name) {
-  symbols.erase(name);
+void SymbolTable::set(std::string_view name, double value) {
+  set(intern(name), value);
 }
 
-void SymbolTable::set(const std::string& name, const TokenValue& value) {
-  symbols[name] = value;
-}
\ No newline at end of file
+void SymbolTable::clear() {
+  slots.clear();
+  names.clear();
+  slot_ids.clear();
+}
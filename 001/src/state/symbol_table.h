@@ -2,22 +2,59 @@
 #define _SYMBOL_TABLE
 
 
+#include <cstdint>
 #include <memory>
 #include <optional>
-#include <string>
+#include <string_view>
 #include <unordered_map>
-#include "../token.h"
+#include <vector>
 
+// variables live in numbered slots. the resolver (resolver.h) gives every
+// variable node its slot once after parsing, so evaluation is an array index.
+// the id and name based overloads are the by-name view for builtins, the
+// repl and error messages
 class SymbolTable {
 private:
+  struct Slot {
+    double value;
+    bool defined;
+  };
+
   std::shared_ptr<SymbolTable> parent = nullptr;
-  std::unordered_map<std::string, TokenValue> symbols{};
+  std::vector<Slot> slots{};
+  // slot -> interned symbol id
+  std::vector<std::uint32_t> names{};
+  // interned symbol id -> slot
+  std::unordered_map<std::uint32_t, std::uint32_t> slot_ids{};
+
 public:
-  std::optional<TokenValue> get(const std::string& name) const;
+  // slot of the variable with symbol id, a new undefined one on first use
+  std::uint32_t resolve(std::uint32_t id);
+  // slot of the variable with symbol id if it has one, never makes one
+  std::optional<std::uint32_t> find(std::uint32_t id) const;
+  std::uint32_t size() const { return slots.size(); }
+  std::uint32_t symbol_of(std::uint32_t slot) const { return names[slot]; }
+
+  // slot must come from resolve()
+  inline std::optional<double> load(std::uint32_t slot) const {
+    if(!slots[slot].defined) return std::nullopt;
+    return slots[slot].value;
+  }
+  inline void store(std::uint32_t slot, double value) { slots[slot] = { value, true }; }
+
+  std::optional<double> get(std::uint32_t id) const;
+  std::optional<double> get(std::string_view name) const;
+
+  void remove(std::uint32_t id);
+  void remove(std::string_view name);
 
-  void remove(const std::string& name);
+  void set(std::uint32_t id, double value);
+  void set(std::string_view name, double value);
 
-  void set(const std::string& name, const TokenValue& value);
+  // forgets every variable and its slot, so a table reused for unrelated
+  // scripts does not keep growing. nodes resolved against it before must
+  // not run again
+  void clear();
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,45 @@
+#ifndef VALUE
+#define VALUE
+
+#include <bit>
+#include <cstdint>
+
+// the runtime value both backends pass around, 8 bytes. a number is stored
+// as its own double bits. every other kind is boxed in the payload of a
+// signalling nan, a pattern arithmetic never produces since it only ever
+// returns quiet nans. for now the only other kind is "no value", what
+// for, while and an if without a match evaluate to.
+//
+// positions and the context are not part of a value, evaluation recovers
+// them from the node it is running when it has to raise an error
+class Value {
+private:
+  static constexpr std::uint64_t NONE_BITS = 0x7ff4000000000000;
+
+  std::uint64_t bits;
+
+  constexpr explicit Value(std::uint64_t bits): bits(bits) {}
+
+public:
+  constexpr Value(): bits(NONE_BITS) {}
+
+  static constexpr Value number(double value) { return Value(std::bit_cast<std::uint64_t>(value)); }
+  static constexpr Value none() { return Value(NONE_BITS); }
+
+  constexpr bool is_none() const { return bits == NONE_BITS; }
+
+  // no value reads as -1 wherever it is used as a number
+  constexpr double as_number() const {
+    return is_none() ? -1 : std::bit_cast<double>(bits);
+  }
+
+  constexpr bool is_true() const { return as_number() != 0; }
+
+  // turns no value into the -1 it reads as, for places that pass it on as
+  // a number (if branches, unary '+')
+  constexpr Value defined() const { return number(as_number()); }
+};
+
+static_assert(sizeof(Value) == 8);
+
+#endif
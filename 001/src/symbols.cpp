@@ -0,0 +1,71 @@
+#include "symbols.h"
+#include <mutex>
+#include <vector>
+
+// what this thread has looked up before. the views point into the names of
+// the one interner, which never move, so they stay valid for the process
+static thread_local std::unordered_map<std::string_view, std::uint32_t> seen_ids{};
+static thread_local std::vector<std::string_view> seen_names{};
+
+SymbolInterner& SymbolInterner::instance() {
+  static SymbolInterner interner;
+  return interner;
+}
+
+std::pair<std::string_view, std::uint32_t> SymbolInterner::insert(std::string_view name) {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = ids.find(name);
+    if(it != ids.end()) return *it;
+  }
+
+  std::unique_lock<std::shared_mutex> lock(mutex);
+
+  // another thread may have added it between the two locks
+  auto it = ids.find(name);
+  if(it != ids.end()) return *it;
+
+  std::uint32_t id = names.size();
+  const std::string& stored = names.emplace_back(name);
+  ids.emplace(stored, id);
+
+  return { stored, id };
+}
+
+std::uint32_t SymbolInterner::intern(std::string_view name) {
+  auto it = seen_ids.find(name);
+  if(it != seen_ids.end()) return it->second;
+
+  auto [stored, id] = insert(name);
+  seen_ids.emplace(stored, id);
+
+  return id;
+}
+
+std::optional<std::uint32_t> SymbolInterner::find(std::string_view name) const {
+  auto seen = seen_ids.find(name);
+  if(seen != seen_ids.end()) return seen->second;
+
+  std::shared_lock<std::shared_mutex> lock(mutex);
+
+  auto it = ids.find(name);
+  if(it == ids.end()) return std::nullopt;
+
+  seen_ids.emplace(*it);
+  return it->second;
+}
+
+std::string_view SymbolInterner::name(std::uint32_t id) const {
+  if(id < seen_names.size() && seen_names[id].data()) return seen_names[id];
+
+  std::string_view stored;
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    stored = names.at(id);
+  }
+
+  if(id >= seen_names.size()) seen_names.resize(id + 1);
+  seen_names[id] = stored;
+
+  return stored;
+}
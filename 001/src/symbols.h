@@ -0,0 +1,48 @@
+#ifndef SYMBOLS
+#define SYMBOLS
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+// process wide identifier table. every distinct name gets a small id the
+// first time the lexer sees it, after that a lookup never allocates.
+// each thread keeps the names it has looked up before in a cache of its
+// own, so the lock is only taken for names new to the thread
+class SymbolInterner {
+private:
+  mutable std::shared_mutex mutex;
+  // deque so the strings never move and the views below stay valid
+  std::deque<std::string> names{};
+  std::unordered_map<std::string_view, std::uint32_t> ids{};
+
+  // the stored name and its id, added if it is new
+  std::pair<std::string_view, std::uint32_t> insert(std::string_view name);
+
+public:
+  static SymbolInterner& instance();
+
+  std::uint32_t intern(std::string_view name);
+  // the id of name if it was interned before, never adds it
+  std::optional<std::uint32_t> find(std::string_view name) const;
+  std::string_view name(std::uint32_t id) const;
+};
+
+inline std::uint32_t intern(std::string_view name) {
+  return SymbolInterner::instance().intern(name);
+}
+
+inline std::optional<std::uint32_t> find_symbol(std::string_view name) {
+  return SymbolInterner::instance().find(name);
+}
+
+inline std::string_view symbol_name(std::uint32_t id) {
+  return SymbolInterner::instance().name(id);
+}
+
+#endif
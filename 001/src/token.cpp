@@ -1,36 +1,38 @@
 #include "token.h"
 #include <string>
-#include <type_traits>
 
-Token::Token(
-  const std::string& type,
-  const std::optional<TokenValue>& value,
-  const std::optional<Position>& pos_start,
-  const std::optional<Position>& pos_end
-): type(type), value(value) {
-  if(pos_start) {
-    this->pos_start = pos_start->copy();
-    this->pos_end = pos_start->copy();
-    this->pos_end->advance();
-  }
-
-  if(pos_end) {
-    this->pos_end = pos_end;
-  }
+Token::Token(TokenKind type, const Position& pos_start)
+  : type(type), pos_start(pos_start), pos_end(pos_start) {
+  pos_end.advance();
 }
 
-bool Token::matches(const std::string& type, const TokenValue& val) const {
-  // return this->type == type && this->value.value() == value;
-  if(!this->value) return false;
+Token::Token(TokenKind type, const Position& pos_start, const Position& pos_end)
+  : type(type), pos_start(pos_start), pos_end(pos_end) {}
 
-  return std::visit([&](const auto& lhs, const auto& rhs) -> bool {
-    using L = std::decay_t<decltype(lhs)>;
-    using R = std::decay_t<decltype(rhs)>;
+std::string kind_name(TokenKind kind) {
+  switch(kind) {
+    case PLS_T: return "plus";
+    case MIN_T: return "minus";
+    case DIV_T: return "divide";
+    case MUL_T: return "multiply";
+    case ID_T:  return "identifier";
+    case KWD_T: return "keyword";
+    case LPR_T: return "lparen";
+    case RPR_T: return "rparen";
+    case INT_T: return "int";
+    case FLT_T: return "float";
+    case EOF_T: return "eof";
+    case EQU_T: return "equals";
+    case POW_T: return "power";
+    case MOD_T: return "modulus";
+    case EE_T:  return "double-equals";
+    case NE_T:  return "not-equal";
+    case LT_T:  return "less-than";
+    case GT_T:  return "greater-than";
+    case LTE_T: return "less-than-or-equal";
+    case GTE_T: return "greater-than-or-equal";
+    case NEWL_T: return "newline";
+  }
 
-    if constexpr (std::is_same_v<L, R>) {
-      return lhs == rhs;
-    } else {
-      return false;
-    }
-  }, this->value.value(), val);
+  return "unknown";
 }
\ No newline at end of file
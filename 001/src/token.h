@@ -1,30 +1,131 @@
 #ifndef TOKEN
 #define TOKEN
 
-#include <memory>
-#include <variant>
-#include <optional>
+#include <array>
+#include <cstdint>
 #include <string>
-#include <sstream>
+#include <string_view>
 #include "position.h"
 
-class Number;
+enum TokenKind : std::uint8_t {
+  PLS_T,
+  MIN_T,
+  DIV_T,
+  MUL_T,
+  ID_T,
+  KWD_T,
+  LPR_T,
+  RPR_T,
+  INT_T,
+  FLT_T,
+  EOF_T,
+  EQU_T,
+  POW_T,
+  MOD_T,
+  EE_T,
+  NE_T,
+  LT_T,
+  GT_T,
+  LTE_T,
+  GTE_T,
+  NEWL_T
+};
+
+// printable name used in syntax errors ("got eof")
+std::string kind_name(TokenKind kind);
+
+enum Keyword : std::uint8_t {
+  KW_VAR,
+  KW_AND,
+  KW_OR,
+  KW_NOT,
+  KW_IF,
+  KW_THEN,
+  KW_ELIF,
+  KW_ELSE,
+  KW_FOR,
+  KW_TO,
+  KW_STEP,
+  KW_WHILE,
+  KW_DO,
+  KW_NONE
+};
+
+constexpr std::array<std::string_view, KW_NONE> KEYWORDS = {
+  "var",
+  "and",
+  "or",
+  "not",
+  "if",
+  "then",
+  "elif",
+  "else",
+  "for",
+  "to",
+  "step",
+  "while",
+  "do"
+};
+
+// perfect hash over KEYWORDS: length, first and last character are enough
+// to give every keyword its own slot, so a lookup is one compare
+constexpr std::size_t KEYWORD_SLOTS = 32;
+
+constexpr std::size_t keyword_hash(std::string_view text) {
+  return (text.size() + (unsigned char)text.front() + 6 * (unsigned char)text.back())
+       & (KEYWORD_SLOTS - 1);
+}
+
+constexpr std::array<Keyword, KEYWORD_SLOTS> make_keyword_table() {
+  std::array<Keyword, KEYWORD_SLOTS> table{};
+  table.fill(KW_NONE);
 
-using TokenValue = std::variant<int, double, std::string, std::shared_ptr<Number>>;
+  for(std::size_t i = 0; i < KEYWORDS.size(); i++) {
+    table[keyword_hash(KEYWORDS[i])] = static_cast<Keyword>(i);
+  }
 
+  return table;
+}
+
+constexpr std::array<Keyword, KEYWORD_SLOTS> KEYWORD_TABLE = make_keyword_table();
+
+constexpr bool keyword_table_is_perfect() {
+  for(std::size_t i = 0; i < KEYWORDS.size(); i++) {
+    if(KEYWORD_TABLE[keyword_hash(KEYWORDS[i])] != i) return false;
+  }
+  return true;
+}
+
+static_assert(keyword_table_is_perfect(), "keyword hash has a collision");
+
+constexpr Keyword keyword_lookup(std::string_view text) {
+  if(text.empty()) return KW_NONE;
+
+  Keyword kw = KEYWORD_TABLE[keyword_hash(text)];
+  return (kw != KW_NONE && KEYWORDS[kw] == text) ? kw : KW_NONE;
+}
+
+// tokens never own text: the lexeme is the [pos_start, pos_end) range of the
+// source, identifiers are interned and numbers are already converted
 struct Token {
-  std::string type;
-  std::optional<TokenValue> value;
-  std::optional<Position> pos_start, pos_end;
-
-  Token(
-    const std::string& type,
-    const std::optional<TokenValue>& value = std::nullopt,
-    const std::optional<Position>& pos_start = std::nullopt,
-    const std::optional<Position>& pos_end = std::nullopt
-  );
-
-  bool matches(const std::string& type, const TokenValue& value) const;
+  TokenKind type = EOF_T;
+  Position pos_start, pos_end;
+  // keyword id for KWD_T tokens, interned symbol id for ID_T tokens
+  std::uint32_t id = 0;
+  // value of INT_T and FLT_T tokens
+  double number = 0;
+
+  Token() = default;
+  Token(TokenKind type, const Position& pos_start);
+  Token(TokenKind type, const Position& pos_start, const Position& pos_end);
+
+  inline bool matches(TokenKind type, std::uint32_t id) const {
+    return this->type == type && this->id == id;
+  }
+
+  inline std::string_view lexeme(std::string_view text) const {
+    return text.substr(pos_start.get_idx(), pos_end.get_idx() - pos_start.get_idx());
+  }
 };
 
-#endif
\ No newline at end of file
+#endif
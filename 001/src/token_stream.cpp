@@ -0,0 +1,51 @@
+#include "token_stream.h"
+#include "lexer.h"
+
+TokenStream::TokenStream(Lexer& lexer): lexer(lexer) {}
+
+void TokenStream::fill() {
+  std::size_t tail = (head + count) % LOOKAHEAD;
+
+  if(done) {
+    // past the end, keep handing out the last (eof) token
+    ring[tail] = ring[(tail + LOOKAHEAD - 1) % LOOKAHEAD];
+    count++;
+    return;
+  }
+
+  Result<Token> tok = lexer.next_token();
+
+  if(!tok) {
+    error = tok.error();
+    ring[tail] = Token(EOF_T, Position());
+  } else {
+    ring[tail] = tok.value();
+  }
+
+  if(ring[tail].type == EOF_T) done = true;
+  count++;
+}
+
+const Token& TokenStream::peek(std::size_t k) {
+  while(count <= k) fill();
+  return ring[(head + k) % LOOKAHEAD];
+}
+
+Token TokenStream::next() {
+  if(count == 0) fill();
+
+  Token tok = ring[head];
+  head = (head + 1) % LOOKAHEAD;
+  count--;
+
+  return tok;
+}
+
+void TokenStream::drain() {
+  while(!done) {
+    Result<Token> tok = lexer.next_token();
+
+    if(!tok) error = tok.error();
+    if(!tok || tok->type == EOF_T) done = true;
+  }
+}
@@ -0,0 +1,40 @@
+#ifndef TOKEN_STREAM
+#define TOKEN_STREAM
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include "result.h"
+#include "token.h"
+
+class Lexer;
+
+// pulls tokens from the lexer on demand and keeps only a small window of
+// lookahead, so memory does not grow with the length of the script.
+// a lexing error ends the stream: it is recorded and EOF is returned
+class TokenStream {
+public:
+  static constexpr std::size_t LOOKAHEAD = 4;
+
+private:
+  Lexer& lexer;
+  std::array<Token, LOOKAHEAD> ring{};
+  std::size_t head = 0, count = 0;
+  bool done = false;
+  ErrorId error = NO_ERROR;
+
+  void fill();
+
+public:
+  TokenStream(Lexer& lexer);
+
+  // k-th token ahead without consuming, k < LOOKAHEAD
+  const Token& peek(std::size_t k = 0);
+  Token next();
+  // lex to the end of the input, only needed to find a pending lexing error
+  void drain();
+
+  inline ErrorId get_error() const { return error; }
+};
+
+#endif
@@ -0,0 +1,21 @@
+#include "bytecode.h"
+
+std::size_t Chunk::emit(
+  OpCode op,
+  std::uint32_t arg,
+  const Position& pos_start,
+  const Position& pos_end
+) {
+  code.push_back(encode(op, arg));
+  spans.push_back({ pos_start, pos_end });
+  return code.size() - 1;
+}
+
+void Chunk::patch(std::size_t at) {
+  code[at] = encode(opcode_of(code[at]), code.size());
+}
+
+std::uint32_t Chunk::add_constant(double value) {
+  constants.push_back(value);
+  return constants.size() - 1;
+}
@@ -0,0 +1,95 @@
+#ifndef BYTECODE
+#define BYTECODE
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "../position.h"
+
+// every instruction is one 32 bit word: the opcode in the low byte and a
+// 24 bit operand (constant index, variable slot, symbol id or jump target)
+// above it
+using Instruction = std::uint32_t;
+
+enum OpCode : std::uint8_t {
+  OP_CONST,       // push constants[arg]
+  OP_NONE,        // push the "no value" of for, while and an if without a match
+  OP_LOAD,        // push the variable in slot arg
+  OP_STORE,       // slot arg = top, the value stays on the stack
+  OP_POP,
+  OP_DEFINE,      // turn a "no value" on top into a plain -1
+
+  OP_ADD,
+  OP_SUB,
+  OP_MUL,
+  OP_DIV,         // arg 1: blame the span of the last OP_BLAME on failure
+  OP_POW,
+  OP_MOD,         // same as OP_DIV
+  OP_EE,
+  OP_NE,
+  OP_LT,
+  OP_GT,
+  OP_LTE,
+  OP_GTE,
+  OP_NEG,
+  OP_NOT,
+
+  OP_JUMP,          // jump to arg
+  OP_JUMP_IF_FALSE, // pop, jump to arg if it is 0
+  OP_JUMP_IF_TRUE,  // pop, jump to arg unless it is 0
+
+  // counted loops keep [i, end, step] on the stack, i being the value of
+  // the current iteration
+  OP_FOR_PREP,    // pop the loop and jump to arg if it does not run at all
+  OP_FOR_VAR,     // slot arg = i, for bodies that use the loop variable
+  OP_FOR_LOOP,    // i += step, jump back to arg while the loop condition holds
+  OP_FOR_EXIT,    // slot arg = i and pop the loop, for bodies that do not
+
+  OP_BLAME,       // the next division by zero is reported at this span
+  OP_BUILTIN,     // fail, assigning to the builtin named by arg
+  OP_RESULT,      // pop the value of a top level statement
+  OP_HALT
+};
+
+constexpr std::uint32_t MAX_OPERAND = (1u << 24) - 1;
+
+constexpr Instruction encode(OpCode op, std::uint32_t arg = 0) {
+  return static_cast<Instruction>(op) | (arg << 8);
+}
+
+constexpr OpCode opcode_of(Instruction ins) {
+  return static_cast<OpCode>(ins & 0xff);
+}
+
+constexpr std::uint32_t operand_of(Instruction ins) {
+  return ins >> 8;
+}
+
+// source range blamed when an instruction fails at runtime
+struct SourceSpan {
+  Position pos_start, pos_end;
+};
+
+// a for loop whose body does not use its variable. while the code in
+// [begin, end) runs, the variable is only in stack[base], and an error
+// raised there has to store it before it returns
+struct HiddenLoop {
+  std::uint32_t begin, end, slot, base;
+};
+
+struct Chunk {
+  std::vector<Instruction> code{};
+  std::vector<double> constants{};
+  // parallel to code, only read on the error path
+  std::vector<SourceSpan> spans{};
+  // deepest the value stack gets, so the vm can size it once
+  std::uint32_t max_stack = 0;
+  std::vector<HiddenLoop> hidden_loops{};
+
+  std::size_t emit(OpCode op, std::uint32_t arg, const Position& pos_start, const Position& pos_end);
+  // points the jump at `at` to the next instruction to be emitted
+  void patch(std::size_t at);
+  std::uint32_t add_constant(double value);
+};
+
+#endif
@@ -0,0 +1,285 @@
+#include "compiler.h"
+#include "../state/interpreter.h"
+#include "../symbols.h"
+#include "../token.h"
+#include <algorithm>
+#include <bit>
+
+std::size_t Compiler::emit(OpCode op, std::uint32_t arg, const SourceSpan& span, int effect) {
+  if(arg > MAX_OPERAND) too_large = true;
+
+  depth += effect;
+  chunk.max_stack = std::max(chunk.max_stack, depth);
+
+  return chunk.emit(op, arg, span.pos_start, span.pos_end);
+}
+
+std::size_t Compiler::emit(OpCode op, std::uint32_t arg, const ASTNode* node, int effect) {
+  return emit(op, arg, { node->get_pos_start(), node->get_pos_end() }, effect);
+}
+
+std::uint32_t Compiler::constant(double value) {
+  // loop bodies repeat the same few literals, share them. keyed by the bit
+  // pattern so 0 and -0 stay apart
+  auto [it, inserted] = constant_ids.try_emplace(std::bit_cast<std::uint64_t>(value), 0);
+  if(inserted) it->second = chunk.add_constant(value);
+  return it->second;
+}
+
+Result<Chunk> Compiler::compile(const ASTNode* program) {
+  Compiler compiler;
+
+  if(program->kind == NODE_STATEMENTS) {
+    // top level statements each hand their value to the vm as they finish
+    for(const ASTNode* statement : static_cast<const StatementsNode*>(program)->statements) {
+      compiler.compile_node(statement);
+      compiler.emit(OP_RESULT, 0, statement, -1);
+    }
+  } else {
+    compiler.compile_node(program);
+    compiler.emit(OP_RESULT, 0, program, -1);
+  }
+
+  compiler.emit(OP_HALT, 0, program, 0);
+
+  if(compiler.too_large || compiler.chunk.code.size() > MAX_OPERAND) {
+    return fail(std::make_shared<Exception>(
+      program->get_pos_start(), program->get_pos_end(),
+      "Compile Error", "program is too large for the bytecode vm"
+    ));
+  }
+
+  return std::move(compiler.chunk);
+}
+
+void Compiler::compile_node(const ASTNode* node) {
+  switch(node->kind) {
+    case NODE_NUMBER:
+      emit(OP_CONST, constant(static_cast<const NumberNode*>(node)->value), node, 1);
+      break;
+    case NODE_VAR_ACCESS:
+      emit(OP_LOAD, static_cast<const VarAccessNode*>(node)->slot, node, 1);
+      break;
+    case NODE_VAR_ASSIGN: compile_var_assign(*static_cast<const VarAssignNode*>(node)); break;
+    case NODE_BIN_OP: compile_bin_op(*static_cast<const BinOpNode*>(node)); break;
+    case NODE_UNARY_OP: compile_unary_op(*static_cast<const UnaryOpNode*>(node)); break;
+    case NODE_IF: compile_if(*static_cast<const IfNode*>(node)); break;
+    case NODE_FOR: compile_for(*static_cast<const ForNode*>(node)); break;
+    case NODE_WHILE: compile_while(*static_cast<const WhileNode*>(node)); break;
+    case NODE_STATEMENTS: compile_statements(*static_cast<const StatementsNode*>(node)); break;
+  }
+}
+
+void Compiler::compile_bin_op(const BinOpNode& node) {
+  if(node.op == BIN_AND || node.op == BIN_OR) {
+    compile_logic(node);
+    return;
+  }
+
+  compile_node(node.left_node);
+
+  // an if hands on the value of the branch that ran, so which range to blame
+  // is only known at runtime
+  const ASTNode* origin = value_origin(node.right_node);
+  bool dynamic = (node.op == BIN_DIV || node.op == BIN_MOD) && origin->kind == NODE_IF;
+
+  if(dynamic) blame_if = origin;
+  compile_node(node.right_node);
+
+  OpCode op = OP_ADD;
+
+  switch(node.op) {
+    case BIN_ADD: op = OP_ADD; break;
+    case BIN_SUB: op = OP_SUB; break;
+    case BIN_MUL: op = OP_MUL; break;
+    case BIN_DIV: op = OP_DIV; break;
+    case BIN_POW: op = OP_POW; break;
+    case BIN_MOD: op = OP_MOD; break;
+    case BIN_EE:  op = OP_EE; break;
+    case BIN_NE:  op = OP_NE; break;
+    case BIN_LT:  op = OP_LT; break;
+    case BIN_GT:  op = OP_GT; break;
+    case BIN_LTE: op = OP_LTE; break;
+    case BIN_GTE: op = OP_GTE; break;
+    // compiled to jumps by compile_logic
+    case BIN_AND:
+    case BIN_OR:  break;
+  }
+
+  if(op == OP_DIV || op == OP_MOD) {
+    emit(op, dynamic, origin, -1);
+  } else {
+    emit(op, 0, &node, -1);
+  }
+}
+
+// emits code that jumps to every position later patched into jumps when
+// the truth of node is `when`, and falls through otherwise. and, or and not
+// turn into control flow here instead of leaving a 0 or 1 on the stack
+void Compiler::compile_jump(const ASTNode* node, bool when, std::vector<std::size_t>& jumps) {
+  if(node->kind == NODE_BIN_OP) {
+    const auto& bin_op = *static_cast<const BinOpNode*>(node);
+
+    if(bin_op.op == BIN_AND || bin_op.op == BIN_OR) {
+      // the truth of a left side that decides the result alone
+      bool decides = bin_op.op == BIN_OR;
+
+      if(when == decides) {
+        compile_jump(bin_op.left_node, when, jumps);
+        compile_jump(bin_op.right_node, when, jumps);
+      } else {
+        std::vector<std::size_t> skip;
+        compile_jump(bin_op.left_node, decides, skip);
+        compile_jump(bin_op.right_node, when, jumps);
+        for(std::size_t at : skip) chunk.patch(at);
+      }
+
+      return;
+    }
+  }
+
+  if(node->kind == NODE_UNARY_OP && static_cast<const UnaryOpNode*>(node)->op == UN_NOT) {
+    compile_jump(static_cast<const UnaryOpNode*>(node)->node, !when, jumps);
+    return;
+  }
+
+  compile_node(node);
+  jumps.push_back(emit(when ? OP_JUMP_IF_TRUE : OP_JUMP_IF_FALSE, 0, node, -1));
+}
+
+// and/or as a value: the right side only runs when the left does not
+// decide the result, which is then 0 or 1
+void Compiler::compile_logic(const BinOpNode& node) {
+  std::uint32_t base = depth;
+  std::vector<std::size_t> is_false;
+
+  compile_jump(&node, false, is_false);
+  emit(OP_CONST, constant(1), &node, 1);
+  std::size_t exit = emit(OP_JUMP, 0, &node, 0);
+
+  for(std::size_t at : is_false) chunk.patch(at);
+  depth = base;
+  emit(OP_CONST, constant(0), &node, 1);
+
+  chunk.patch(exit);
+}
+
+void Compiler::compile_unary_op(const UnaryOpNode& node) {
+  compile_node(node.node);
+
+  if(node.op == UN_MINUS) {
+    emit(OP_NEG, 0, &node, 0);
+  } else if(node.op == UN_PLUS && may_be_undefined(node.node)) {
+    emit(OP_DEFINE, 0, &node, 0);
+  } else if(node.op == UN_NOT) {
+    emit(OP_NOT, 0, &node, 0);
+  }
+}
+
+void Compiler::compile_var_assign(const VarAssignNode& node) {
+  compile_node(node.value_node);
+
+  // known when compiling, but reported only once the value has evaluated
+  // without an error, like the tree walker does
+  if(is_builtin(node.var_name)) {
+    emit(OP_BUILTIN, node.var_name, &node, 0);
+  }
+
+  emit(OP_STORE, node.slot, &node, 0);
+}
+
+void Compiler::compile_branch(const ASTNode* expr, bool blame) {
+  const ASTNode* origin = value_origin(expr);
+
+  if(blame && origin->kind == NODE_IF) blame_if = origin;
+  compile_node(expr);
+  if(may_be_undefined(expr)) emit(OP_DEFINE, 0, expr, 0);
+  if(blame && origin->kind != NODE_IF) emit(OP_BLAME, 0, origin, 0);
+}
+
+void Compiler::compile_if(const IfNode& node) {
+  std::vector<std::size_t> exits;
+  std::uint32_t base = depth;
+
+  bool blame = blame_if == &node;
+  blame_if = nullptr;
+
+  for(const auto&[condition, expr] : node.cases) {
+    std::vector<std::size_t> next;
+    compile_jump(condition, false, next);
+
+    compile_branch(expr, blame);
+    exits.push_back(emit(OP_JUMP, 0, expr, 0));
+
+    for(std::size_t at : next) chunk.patch(at);
+    depth = base;
+  }
+
+  if(node.else_case) {
+    compile_branch(node.else_case, blame);
+  } else {
+    emit(OP_NONE, 0, &node, 1);
+  }
+
+  for(std::size_t at : exits) chunk.patch(at);
+}
+
+void Compiler::compile_for(const ForNode& node) {
+  compile_node(node.start_value);
+  compile_node(node.end_value);
+
+  if(node.step_value) {
+    compile_node(node.step_value);
+  } else {
+    emit(OP_CONST, constant(1), &node, 1);
+  }
+
+  std::uint32_t base = depth - 3;
+  std::size_t prep = emit(OP_FOR_PREP, 0, &node, 0);
+  std::size_t body = chunk.code.size();
+
+  if(node.var_in_body) emit(OP_FOR_VAR, node.slot, &node, 0);
+
+  compile_node(node.body);
+  emit(OP_POP, 0, node.body, -1);
+  std::size_t loop = emit(OP_FOR_LOOP, body, &node, 0);
+
+  if(node.var_in_body) {
+    for(int k = 0; k < 3; k++) emit(OP_POP, 0, &node, -1);
+  } else {
+    emit(OP_FOR_EXIT, node.slot, &node, -3);
+    chunk.hidden_loops.push_back({
+      static_cast<std::uint32_t>(body), static_cast<std::uint32_t>(loop), node.slot, base
+    });
+  }
+
+  chunk.patch(prep);
+  emit(OP_NONE, 0, &node, 1);
+}
+
+void Compiler::compile_while(const WhileNode& node) {
+  std::size_t top = chunk.code.size();
+
+  std::vector<std::size_t> exits;
+  compile_jump(node.condition, false, exits);
+
+  compile_node(node.body);
+  emit(OP_POP, 0, node.body, -1);
+  emit(OP_JUMP, top, &node, 0);
+
+  for(std::size_t at : exits) chunk.patch(at);
+  emit(OP_NONE, 0, &node, 1);
+}
+
+void Compiler::compile_statements(const StatementsNode& node) {
+  if(node.statements.empty()) {
+    emit(OP_NONE, 0, &node, 1);
+    return;
+  }
+
+  // a nested block evaluates to its last statement
+  for(std::size_t i = 0; i < node.statements.size(); i++) {
+    compile_node(node.statements[i]);
+    if(i + 1 < node.statements.size()) emit(OP_POP, 0, node.statements[i], -1);
+  }
+}
@@ -0,0 +1,50 @@
+#ifndef COMPILER
+#define COMPILER
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "bytecode.h"
+#include "../exception.h"
+#include "../nodes.h"
+#include "../result.h"
+
+// lowers a parsed program into a chunk for the vm. every value a node
+// produces for the tree walker is left on the vm stack instead
+class Compiler {
+private:
+  Chunk chunk;
+  std::unordered_map<std::uint64_t, std::uint32_t> constant_ids{};
+  std::uint32_t depth = 0;
+  bool too_large = false;
+  // an if whose value is divided by, its branches mark where the value came from
+  const ASTNode* blame_if = nullptr;
+
+  Compiler() = default;
+
+  // effect is how many values op leaves on the stack minus how many it takes
+  std::size_t emit(OpCode op, std::uint32_t arg, const SourceSpan& span, int effect);
+  std::size_t emit(OpCode op, std::uint32_t arg, const ASTNode* node, int effect);
+  std::uint32_t constant(double value);
+
+  void compile_node(const ASTNode* node);
+  void compile_bin_op(const BinOpNode& node);
+  void compile_jump(const ASTNode* node, bool when, std::vector<std::size_t>& jumps);
+  void compile_logic(const BinOpNode& node);
+  void compile_unary_op(const UnaryOpNode& node);
+  void compile_var_assign(const VarAssignNode& node);
+  void compile_branch(const ASTNode* expr, bool blame);
+  void compile_if(const IfNode& node);
+  void compile_for(const ForNode& node);
+  void compile_while(const WhileNode& node);
+  void compile_statements(const StatementsNode& node);
+
+public:
+  // program is the StatementsNode the parser returns
+  static Result<Chunk> compile(const ASTNode* program);
+};
+
+#endif
@@ -0,0 +1,169 @@
+#include "vm.h"
+#include "../symbols.h"
+#include <cmath>
+#include <string>
+#include <vector>
+
+Result<Value> VirtualMachine::run(const Chunk& chunk, Context& context, const StatementSink& sink) const {
+  std::vector<Value> stack(chunk.max_stack);
+  Value* sp = stack.data();
+  Value last = Value::none();
+
+  const Instruction* code = chunk.code.data();
+  const double* constants = chunk.constants.data();
+  SymbolTable& symbols = *context.symbol_table;
+  std::size_t ip = 0;
+  std::size_t blame = 0;
+
+  // reports the span of instruction `at`, usually the one that just ran
+  auto error_at = [&](std::size_t at, const std::string& details) -> Failure {
+    for(const HiddenLoop& loop : chunk.hidden_loops) {
+      if(ip - 1 >= loop.begin && ip - 1 < loop.end) {
+        symbols.store(loop.slot, stack[loop.base].as_number());
+      }
+    }
+
+    const SourceSpan& span = chunk.spans[at];
+    return fail(std::make_shared<RTException>(
+      context, span.pos_start, span.pos_end, details
+    ));
+  };
+
+  auto name_of = [&](std::uint32_t slot) {
+    return std::string(symbol_name(symbols.symbol_of(slot)));
+  };
+
+// pops the right operand and replaces the left one with the result
+#define BINARY(expr) { \
+    double b = (--sp)->as_number(); \
+    double a = sp[-1].as_number(); \
+    sp[-1] = Value::number(expr); \
+    break; \
+  }
+
+  for(;;) {
+    Instruction ins = code[ip++];
+
+    switch(opcode_of(ins)) {
+      case OP_CONST:
+        *sp++ = Value::number(constants[operand_of(ins)]);
+        break;
+
+      case OP_NONE:
+        *sp++ = Value::none();
+        break;
+
+      case OP_LOAD: {
+        std::optional<double> value = symbols.load(operand_of(ins));
+        if(!value) {
+          return error_at(ip - 1, std::string("'") + name_of(operand_of(ins)) + "' is not defined");
+        }
+        *sp++ = Value::number(value.value());
+        break;
+      }
+
+      case OP_STORE:
+        if(sp[-1].is_none()) {
+          return error_at(ip - 1, std::string("'") + name_of(operand_of(ins)) + "' is not defined");
+        }
+        symbols.store(operand_of(ins), sp[-1].as_number());
+        break;
+
+      case OP_POP:
+        sp--;
+        break;
+
+      case OP_DEFINE:
+        sp[-1] = sp[-1].defined();
+        break;
+
+      case OP_ADD: BINARY(apply_binary<BIN_ADD>(a, b))
+      case OP_SUB: BINARY(apply_binary<BIN_SUB>(a, b))
+      case OP_MUL: BINARY(apply_binary<BIN_MUL>(a, b))
+      case OP_POW: BINARY(apply_binary<BIN_POW>(a, b))
+
+      case OP_DIV:
+        if(sp[-1].as_number() == 0) return error_at(operand_of(ins) ? blame : ip - 1, "division by zero");
+        BINARY(apply_binary<BIN_DIV>(a, b))
+
+      case OP_MOD:
+        if(sp[-1].as_number() == 0) return error_at(operand_of(ins) ? blame : ip - 1, "modulus by zero");
+        BINARY(apply_binary<BIN_MOD>(a, b))
+
+      case OP_EE:  BINARY(apply_binary<BIN_EE>(a, b))
+      case OP_NE:  BINARY(apply_binary<BIN_NE>(a, b))
+      case OP_LT:  BINARY(apply_binary<BIN_LT>(a, b))
+      case OP_GT:  BINARY(apply_binary<BIN_GT>(a, b))
+      case OP_LTE: BINARY(apply_binary<BIN_LTE>(a, b))
+      case OP_GTE: BINARY(apply_binary<BIN_GTE>(a, b))
+
+      case OP_NEG:
+        sp[-1] = Value::number(apply_unary<UN_MINUS>(sp[-1].as_number()));
+        break;
+
+      case OP_NOT:
+        sp[-1] = Value::number(apply_unary<UN_NOT>(sp[-1].as_number()));
+        break;
+
+      case OP_JUMP:
+        ip = operand_of(ins);
+        break;
+
+      case OP_JUMP_IF_FALSE:
+        if(!(--sp)->is_true()) ip = operand_of(ins);
+        break;
+
+      case OP_JUMP_IF_TRUE:
+        if((--sp)->is_true()) ip = operand_of(ins);
+        break;
+
+      case OP_FOR_PREP: {
+        double i = sp[-3].as_number(), end = sp[-2].as_number(), step = sp[-1].as_number();
+        if(!(step >= 0 ? i < end : i > end)) {
+          sp -= 3;
+          ip = operand_of(ins);
+        }
+        break;
+      }
+
+      case OP_FOR_VAR:
+        symbols.store(operand_of(ins), sp[-3].as_number());
+        break;
+
+      case OP_FOR_LOOP: {
+        double i = sp[-3].as_number() + sp[-1].as_number();
+        double end = sp[-2].as_number();
+        if(sp[-1].as_number() >= 0 ? i < end : i > end) {
+          sp[-3] = Value::number(i);
+          ip = operand_of(ins);
+        }
+        break;
+      }
+
+      case OP_FOR_EXIT:
+        symbols.store(operand_of(ins), sp[-3].as_number());
+        sp -= 3;
+        break;
+
+      case OP_BLAME:
+        blame = ip - 1;
+        break;
+
+      case OP_BUILTIN:
+        return error_at(
+          ip - 1,
+          std::string("cannot reassign built-in variable '") + std::string(symbol_name(operand_of(ins))) + "'"
+        );
+
+      case OP_RESULT:
+        last = *--sp;
+        if(sink && !last.is_none()) sink(Number(last.as_number()));
+        break;
+
+      case OP_HALT:
+        return last;
+    }
+  }
+
+#undef BINARY
+}
@@ -0,0 +1,18 @@
+#ifndef VIRTUAL_MACHINE
+#define VIRTUAL_MACHINE
+
+#include "bytecode.h"
+#include "../context.h"
+#include "../result.h"
+#include "../state/interpreter.h"
+
+// stack machine for chunks made by Compiler. variables live in the
+// context's symbol table, exactly as they do for the tree walker
+class VirtualMachine {
+public:
+  // sink, if set, gets the value of each top level statement as it completes.
+  // the result is the value of the last one
+  Result<Value> run(const Chunk& chunk, Context& context, const StatementSink& sink = nullptr) const;
+};
+
+#endif
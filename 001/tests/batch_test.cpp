@@ -0,0 +1,141 @@
+#include <random>
+#include <string>
+#include <vector>
+#include "check.h"
+#include "expressions.h"
+#include "../src/batch/batch.h"
+#include "../src/exception.h"
+
+// BatchProgram::evaluate against the scalar Program row by row, and
+// against run() on every backend, for generated expressions and for
+// formulas that meet a zero divisor on some rows
+
+static const std::size_t ROWS = 2 * BATCH_SIZE + 452;
+static const double VALUES[] = { 0, 1, -1, 2, 0.5, 3, -2.5, 10 };
+static const char* NAMES[] = { "x", "y", "z" };
+
+// inputs come from a fixed seed too
+static std::mt19937 rng(5);
+
+struct Inputs {
+  std::vector<double> columns[3];
+
+  // z is mostly not 0, so divisions by it flag some blocks without
+  // failing on their first row
+  Inputs() {
+    for(int c = 0; c < 3; c++) {
+      columns[c].resize(ROWS);
+      for(double& value : columns[c]) {
+        value = VALUES[rng() % 8];
+        if(c == 2 && rng() % 4 != 0 && value == 0) value = 1;
+      }
+    }
+  }
+};
+
+// the scalar program on rows up to and including the first that fails
+static std::vector<RunType> scalar_rows(const Program& program, const Inputs& inputs) {
+  std::vector<RunType> results;
+  Bindings bindings = program.bind();
+
+  for(std::size_t row = 0; row < ROWS; row++) {
+    for(int c = 0; c < 3; c++) {
+      if(auto slot = program.slot_of(NAMES[c])) bindings.set(*slot, inputs.columns[c][row]);
+    }
+
+    results.push_back(program.evaluate(bindings));
+    if(results.back().second) break;
+  }
+
+  return results;
+}
+
+static RunType run_row(const std::string& text, const Inputs& inputs, std::size_t row, Backend backend) {
+  RunOptions options;
+  options.backend = backend;
+
+  std::string script;
+  for(int c = 0; c < 3; c++) script += std::string("var ") + NAMES[c] + " = " + number_text(inputs.columns[c][row]) + "\n";
+
+  return run("<run>", script + text, options);
+}
+
+// false when the expression is not one the batch compiler takes
+static bool check_expression(const std::string& text, const Inputs& inputs) {
+  auto [program, error] = compile("<batch>", text);
+  check(program != nullptr, std::string("compiles: ") + text);
+  if(!program) return false;
+
+  auto [batch, batch_error] = BatchProgram::compile(program);
+  if(!batch) return false;
+
+  Columns columns(*program);
+  for(int c = 0; c < 3; c++) {
+    if(auto slot = program->slot_of(NAMES[c])) columns.set(*slot, inputs.columns[c]);
+  }
+
+  std::vector<double> out(ROWS);
+  std::shared_ptr<Exception> batch_failure = batch->evaluate(columns, out);
+  std::vector<RunType> expected = scalar_rows(*program, inputs);
+
+  // the same values up to the row that fails, and the very same error
+  std::shared_ptr<Exception> scalar_failure = expected.back().second;
+  std::size_t good = expected.size() - (scalar_failure ? 1 : 0);
+
+  for(std::size_t row = 0; row < good; row++) {
+    if(!same(out[row], number_of(expected[row]))) {
+      check(false, text + " row " + std::to_string(row) + ": " + number_text(out[row]) +
+                   std::string(", scalar ") + describe(expected[row]));
+      break;
+    }
+  }
+
+  check(
+    (batch_failure == nullptr) == (scalar_failure == nullptr) &&
+      (!batch_failure || batch_failure->as_string() == scalar_failure->as_string()),
+    text + " fails as the scalar program does: " + headline(batch_failure) + ", scalar " + headline(scalar_failure)
+  );
+
+  // a few rows through run(), the last of them the one that fails
+  for(std::size_t row : { (std::size_t)0, good / 2, expected.size() - 1 }) {
+    for(Backend backend : { BACKEND_TREE, BACKEND_VM, BACKEND_CLOSURE }) {
+      RunType result = run_row(text, inputs, row, backend);
+      check(
+        same_result(expected[row], result),
+        text + " row " + std::to_string(row) + ", backend " + std::to_string(backend) + ": " +
+          describe(expected[row]) + ", run() gave " + describe(result)
+      );
+    }
+  }
+
+  return true;
+}
+
+int main() {
+  Inputs inputs;
+
+  // zero divisors: skipped by a branch, in a flagged block re-evaluated row by
+  // row, 0 / 0, and divisions that fail
+  std::vector<std::string> formulas = {
+    "if z then x / z else 0",
+    "if z == 0 then 0 elif x then y / z else x % z",
+    "(x - x) / (x - x) * 0",
+    "z and x / z",
+    "x / z",
+    "y % z + x",
+  };
+
+  ExpressionGenerator generate(5);
+  for(int i = 0; i < 400; i++) formulas.push_back(generate());
+
+  int compiled = 0;
+  for(const std::string& text : formulas) compiled += check_expression(text, inputs);
+
+  check(compiled > 300, std::string("most expressions compile to batch programs, ") + std::to_string(compiled) + " did");
+
+  // the batch compiler turns down what it cannot run block by block
+  auto [program, error] = compile("<batch>", "var y = x\ny");
+  check(program && !BatchProgram::compile(program).first, "assignments are not batched");
+
+  return finish();
+}
@@ -0,0 +1,84 @@
+#ifndef CHECK
+#define CHECK
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include "../src/lexer.h"
+
+// tiny helpers shared by the test programs in tests/. every failed check is
+// printed, a program fails if any of its checks did
+
+inline std::mutex check_mutex;
+inline int failures = 0;
+
+// checks may be made from several threads at once
+inline void check(bool ok, const std::string& what) {
+  if(ok) return;
+
+  std::lock_guard<std::mutex> lock(check_mutex);
+  std::fprintf(stderr, "FAILED: %s\n", what.c_str());
+  failures++;
+}
+
+// equal bit for bit, or both NaN
+inline bool same(double a, double b) {
+  if(std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+  return std::memcmp(&a, &b, sizeof a) == 0;
+}
+
+// exact enough to read back the same double
+inline std::string number_text(double value) {
+  char text[32];
+  std::snprintf(text, sizeof text, "%.17g", value);
+  return text;
+}
+
+// the number a script ran to, NaN when it failed or gave none
+inline double number_of(const RunType& result) {
+  if(result.second || !result.first) return NAN;
+
+  const Number* number = std::get_if<Number>(&result.first.value());
+  return number ? number->get_value() : NAN;
+}
+
+// what went wrong without where: the line naming the kind of error, as
+// in "Runtime Error: division by zero"
+inline std::string headline(const std::shared_ptr<Exception>& error) {
+  if(!error) return "";
+
+  std::string text = error->as_string();
+  std::size_t start = 0;
+
+  while(start < text.size()) {
+    std::size_t end = text.find('\n', start);
+    if(end == std::string::npos) end = text.size();
+
+    std::string line = text.substr(start, end - start);
+    if(line.rfind("traceback", 0) != 0 && line.rfind("  File", 0) != 0) return line;
+
+    start = end + 1;
+  }
+
+  return text;
+}
+
+inline std::string describe(const RunType& result) {
+  if(result.second) return headline(result.second);
+  return std::to_string(number_of(result));
+}
+
+// the same value, or errors of the same kind
+inline bool same_result(const RunType& a, const RunType& b) {
+  if(a.second || b.second) return headline(a.second) == headline(b.second);
+  return same(number_of(a), number_of(b));
+}
+
+inline int finish() {
+  if(failures) std::fprintf(stderr, "%d checks failed\n", failures);
+  return failures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,61 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include "check.h"
+#include "../src/engine.h"
+
+// engines owned by threads of their own, running at the same time: every
+// thread interns names no other thread uses and registers scripts and
+// errors of its own, the results must not depend on what the others do
+
+static const unsigned THREADS = 8;
+static const int RUNS = 300;
+
+static void run_thread(unsigned t) {
+  Backend backends[] = { BACKEND_TREE, BACKEND_VM, BACKEND_CLOSURE };
+  std::string fn = std::string("<thread ") + std::to_string(t) + ">";
+  Engine engine;
+
+  for(int i = 0; i < RUNS; i++) {
+    RunOptions options;
+    options.backend = backends[i % 3];
+
+    // a name new to the interner, and one every thread shares
+    std::string own = std::string("v") + std::to_string(t) + "_" + std::to_string(i);
+    std::string text = std::string("var ") + own + " = " + std::to_string(i) + "\n"
+                       "var shared = " + own + " * 2 + " + std::to_string(t) + "\n"
+                       "shared";
+
+    RunType result = engine.run(fn, text, options);
+    check(same(number_of(result), 2.0 * i + t), fn + " run " + std::to_string(i) + ": " + describe(result));
+
+    // the error names the script this thread registered
+    RunType error = engine.run(fn, "1 / (shared - shared)", options);
+    check(
+      error.second && error.second->as_string().find(std::string("File ") + fn + ", line 1") != std::string::npos,
+      fn + " error " + std::to_string(i) + ": " + describe(error)
+    );
+  }
+
+  // globals stay with their engine
+  RunType last = engine.run(fn, std::string("v") + std::to_string(t) + "_" + std::to_string(RUNS - 1));
+  check(same(number_of(last), RUNS - 1), fn + " kept its globals: " + describe(last));
+
+  RunType other = engine.run(fn, std::string("v") + std::to_string((t + 1) % THREADS) + "_0");
+  check(other.second != nullptr, fn + " sees globals of another engine: " + describe(other));
+}
+
+int main() {
+  std::vector<std::thread> threads;
+  for(unsigned t = 0; t < THREADS; t++) threads.emplace_back(run_thread, t);
+  for(std::thread& thread : threads) thread.join();
+
+  // the free run() keeps an engine per thread
+  std::thread first([]() { (void)run("<a>", "var only_here = 1"); });
+  first.join();
+
+  RunType result = run("<b>", "only_here");
+  check(result.second != nullptr, std::string("run() shares globals between threads: ") + describe(result));
+
+  return finish();
+}
@@ -0,0 +1,50 @@
+#ifndef EXPRESSIONS
+#define EXPRESSIONS
+
+#include <cstdint>
+#include <initializer_list>
+#include <random>
+#include <string>
+
+// random expressions over x, y and z for the differential tests, with
+// every operator, unary operators and ifs with elifs. a fixed seed and
+// plain modulo, so every platform tests the same expressions
+class ExpressionGenerator {
+private:
+  std::mt19937 rng;
+
+  std::string pick(std::initializer_list<const char*> choices) {
+    return *(choices.begin() + rng() % choices.size());
+  }
+
+public:
+  explicit ExpressionGenerator(unsigned seed): rng(seed) {}
+
+  // an expression nested at most depth levels
+  std::string operator()(int depth) {
+    int r = rng() % 100;
+
+    if(depth <= 0 || r < 20) return pick({ "x", "y", "z", "0", "1", "2", "0.5", "true", "false", "null" });
+    // not binds looser than comparisons, so it only starts an operand in
+    // parentheses
+    if(r < 30) return std::string("(") + pick({ "-", "not ", "+" }) + (*this)(depth - 1) + ")";
+
+    if(r < 42) {
+      std::string text = std::string("if ") + (*this)(depth - 1) + " then " + (*this)(depth - 1);
+      for(int elifs = rng() % 3; elifs > 0; elifs--) {
+        text += std::string(" elif ") + (*this)(depth - 1) + " then " + (*this)(depth - 1);
+      }
+      return std::string("(") + text + " else " + (*this)(depth - 1) + ")";
+    }
+
+    std::string op = pick({ "+", "-", "*", "/", "^", "%", "==", "!=", "<", ">", "<=", ">=", "and", "or" });
+    return std::string("(") + (*this)(depth - 1) + " " + op + " " + (*this)(depth - 1) + ")";
+  }
+
+  // an expression of random depth, up to five levels
+  std::string operator()() {
+    return (*this)(1 + rng() % 5);
+  }
+};
+
+#endif
@@ -0,0 +1,157 @@
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+#include "check.h"
+#include "expressions.h"
+#include "../src/batch/batch.h"
+#include "../src/exception.h"
+
+// BatchProgram::filter and select against the scalar Program, for filters
+// and plain batch programs alike. the row counts end inside a vector, a
+// bitmap word and a block, so the sse2 mask kernels and their scalar tails
+// both run, and the inputs hold -0, infinities and NaN
+
+static const double VALUES[] = { 0, -0.0, 1, -1, 2, 0.5, INFINITY, -INFINITY, NAN, 3 };
+static const std::size_t ROW_COUNTS[] = { 0, 1, 2, 15, 16, 17, 63, 64, 65, 1023, 1024, 1025, 2500 };
+static const std::size_t MOST_ROWS = 2500;
+static const char* NAMES[] = { "x", "y", "z" };
+
+static std::mt19937 rng(7);
+
+struct Inputs {
+  std::vector<double> columns[3];
+
+  Inputs() {
+    for(std::vector<double>& column : columns) {
+      column.resize(MOST_ROWS);
+      for(double& value : column) value = VALUES[rng() % 10];
+    }
+  }
+};
+
+// whether each row passes, up to the first row that fails
+struct Expected {
+  std::vector<bool> passes;
+  std::shared_ptr<Exception> error;
+};
+
+static Expected scalar_rows(const Program& program, const Inputs& inputs, std::size_t rows) {
+  Expected expected;
+  Bindings bindings = program.bind();
+
+  for(std::size_t row = 0; row < rows; row++) {
+    for(int c = 0; c < 3; c++) {
+      if(auto slot = program.slot_of(NAMES[c])) bindings.set(*slot, inputs.columns[c][row]);
+    }
+
+    RunType result = program.evaluate(bindings);
+    if(result.second) {
+      expected.error = result.second;
+      break;
+    }
+
+    expected.passes.push_back(number_of(result) != 0);
+  }
+
+  return expected;
+}
+
+static bool same_error(const std::shared_ptr<Exception>& a, const std::shared_ptr<Exception>& b) {
+  return (a == nullptr) == (b == nullptr) && (!a || a->as_string() == b->as_string());
+}
+
+static void check_batch(const std::string& text, const Program& program, const BatchProgram& batch, const Inputs& inputs) {
+  Columns columns(program);
+  for(int c = 0; c < 3; c++) {
+    if(auto slot = program.slot_of(NAMES[c])) columns.set(*slot, inputs.columns[c]);
+  }
+
+  for(std::size_t rows : ROW_COUNTS) {
+    Expected expected = scalar_rows(program, inputs, rows);
+    std::string where = text + ", " + std::to_string(rows) + " rows";
+
+    // bits past the last row must be cleared too
+    std::vector<std::uint64_t> bitmap((rows + 63) / 64, ~0ull);
+    std::shared_ptr<Exception> error = batch.filter(columns, rows, bitmap);
+    check(same_error(error, expected.error), where + ", filter fails as the scalar program does: " + headline(error));
+
+    std::vector<std::uint32_t> selected;
+    std::shared_ptr<Exception> select_error = batch.select(columns, rows, selected);
+    check(same_error(select_error, expected.error), where + ", select fails as the scalar program does: " + headline(select_error));
+
+    if(expected.error) continue;
+
+    std::vector<std::uint32_t> passing;
+    bool bits_match = true;
+
+    for(std::size_t row = 0; row < bitmap.size() * 64; row++) {
+      bool pass = row < rows && expected.passes[row];
+      if(pass) passing.push_back(row);
+      bits_match &= ((bitmap[row / 64] >> (row % 64)) & 1) == pass;
+    }
+
+    check(bits_match, where + ", filter bitmap");
+    check(selected == passing, where + ", select indices");
+
+    // select appends
+    std::vector<std::uint32_t> appended = { 7 };
+    (void)batch.select(columns, rows, appended);
+    check(appended.size() == passing.size() + 1 && appended[0] == 7, where + ", select appends");
+  }
+}
+
+static int check_expression(const std::string& text, const Inputs& inputs) {
+  auto [program, error] = compile("<filter>", text);
+  check(program != nullptr, std::string("compiles: ") + text);
+  if(!program) return 0;
+
+  int compiled = 0;
+
+  // as a filter the comparisons and and/or/not make masks, as a plain
+  // program the values are tested at the end
+  for(bool filter : { true, false }) {
+    auto [batch, batch_error] = filter ? BatchProgram::compile_filter(program) : BatchProgram::compile(program);
+    if(!batch) continue;
+
+    check_batch(text + (filter ? " (filter)" : " (values)"), *program, *batch, inputs);
+    compiled++;
+  }
+
+  return compiled;
+}
+
+int main() {
+  Inputs inputs;
+
+  std::vector<std::string> predicates = {
+    "x > y",
+    "x == x",
+    "not (x != y)",
+    "x <= 1 and y >= -1 or z < 0",
+    "x",
+    "not x",
+    "if x < y then y > z else z",
+    "x >= 0 and 1 / x > 0",
+    "(x or y) and not (y and z)",
+  };
+
+  ExpressionGenerator generate(11);
+  for(int i = 0; i < 150; i++) predicates.push_back(generate());
+
+  int compiled = 0;
+  for(const std::string& text : predicates) compiled += check_expression(text, inputs);
+  check(compiled > 200, std::string("most predicates compile to batch programs, ") + std::to_string(compiled) + " did");
+
+  // the indices of select are 32 bits wide
+  auto [program, error] = compile("<filter>", "x > 0");
+  auto [batch, batch_error] = BatchProgram::compile_filter(program);
+  Columns columns(*program);
+  std::vector<std::uint32_t> selected;
+
+  std::shared_ptr<Exception> too_many = batch->select(columns, MAX_SELECT_ROWS + 1, selected);
+  check(too_many && selected.empty(), std::string("select refuses rows past its index width: ") + headline(too_many));
+
+  return finish();
+}
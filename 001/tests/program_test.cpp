@@ -0,0 +1,144 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include "check.h"
+#include "../src/program.h"
+
+// a compiled Program against run() on every backend, for the same inputs
+
+static const char* FORMULAS[] = {
+  "x * rate + fee",
+  "if x > 0 then fee / x else 0",
+  "(x - 1) / (x - 1)",
+  "x % rate",
+  "x ^ 2 - rate",
+  "x >= 2 and rate < 3 or not x",
+  "var y = x * 2\ny + rate",
+};
+
+static const double XS[] = { -2, -0.5, 0, 1, 2.5, 4 };
+static const double RATES[] = { 0, 1.5, 3 };
+static const double FEE = 20;
+
+static RunType run_script(const std::string& formula, double x, double rate, Backend backend) {
+  RunOptions options;
+  options.backend = backend;
+
+  std::string text = std::string("var x = ") + number_text(x) + "\nvar rate = " + number_text(rate) +
+                     std::string("\nvar fee = ") + number_text(FEE) + "\n" + formula;
+  return run("<run>", text, options);
+}
+
+static void set(const Program& program, Bindings& bindings, const char* name, double value) {
+  if(auto slot = program.slot_of(name)) bindings.set(*slot, value);
+}
+
+static void check_against_run() {
+  for(const char* formula : FORMULAS) {
+    auto [program, error] = compile("<program>", formula);
+    check(program && !error, std::string("compiles: ") + formula);
+    if(!program) continue;
+
+    // one set of bindings for every row, only the inputs change
+    Bindings bindings = program->bind();
+
+    for(double x : XS) {
+      for(double rate : RATES) {
+        set(*program, bindings, "x", x);
+        set(*program, bindings, "rate", rate);
+        set(*program, bindings, "fee", FEE);
+
+        RunType result = program->evaluate(bindings);
+
+        for(Backend backend : { BACKEND_TREE, BACKEND_VM, BACKEND_CLOSURE }) {
+          RunType expected = run_script(formula, x, rate, backend);
+          check(
+            same_result(result, expected),
+            std::string(formula) + " at x = " + number_text(x) + ", rate = " + number_text(rate) +
+              std::string(", backend ") + std::to_string(backend) + ": " + describe(result) + ", run() gave " + describe(expected)
+          );
+        }
+      }
+    }
+  }
+}
+
+static void check_slots() {
+  auto [program, error] = compile("<slots>", "var y = x * 2\nif true then y else null");
+  check(program && !error, "slots program compiles");
+  if(!program) return;
+
+  check(program->slot_of("x").has_value(), "an input has a slot");
+  check(program->slot_of("y").has_value(), "an assigned variable has a slot");
+  check(!program->slot_of("never_named").has_value(), "a name the script never mentions has no slot");
+  check(!program->slot_of("true").has_value(), "a builtin has no slot");
+  check(!program->slot_of("null").has_value(), "null has no slot");
+
+  std::uint32_t x = *program->slot_of("x");
+  std::uint32_t y = *program->slot_of("y");
+  Bindings bindings = program->bind();
+
+  check(!bindings.get(x).has_value(), "fresh bindings leave inputs unset");
+
+  RunType unset = program->evaluate(bindings);
+  check(headline(unset.second) == "Runtime Error: 'x' is not defined", std::string("unset input: ") + describe(unset));
+
+  bindings.set(x, 21);
+  RunType result = program->evaluate(bindings);
+  check(same(number_of(result), 42), std::string("bound input: ") + describe(result));
+
+  // what the script assigns stays in the bindings
+  check(bindings.get(y) == 42.0, "assigned variable kept");
+
+  // other bindings of the same program are not touched
+  Bindings other = program->bind();
+  check(!other.get(y).has_value(), "bindings are separate");
+}
+
+static void check_errors() {
+  auto [program, error] = compile("<bad>", "1 +");
+  check(!program && error, "a syntax error fails compile");
+  check(headline(error).rfind("Invalid Syntax", 0) == 0, std::string("syntax error: ") + headline(error));
+
+  auto [lexed, lex_error] = compile("<bad>", "1 $ 2");
+  check(!lexed && headline(lex_error).rfind("Illegal Character", 0) == 0, std::string("lexing error: ") + headline(lex_error));
+}
+
+// one program shared by threads that each bind their own variables
+static void check_threads() {
+  auto [program, error] = compile("<shared>", "if x > 0 then fee / x else x * rate");
+  if(!program) {
+    check(false, "shared program compiles");
+    return;
+  }
+
+  std::vector<std::thread> threads;
+
+  for(unsigned t = 0; t < 4; t++) {
+    threads.emplace_back([&, t]() {
+      Bindings bindings = program->bind();
+
+      for(int i = 0; i < 2000; i++) {
+        double x = (int)((i * 7 + t) % 11) - 5;
+        set(*program, bindings, "x", x);
+        set(*program, bindings, "rate", t);
+        set(*program, bindings, "fee", FEE);
+
+        double expected = x > 0 ? FEE / x : x * t;
+        RunType result = program->evaluate(bindings);
+        check(same(number_of(result), expected), std::string("thread ") + std::to_string(t) + ": " + describe(result));
+      }
+    });
+  }
+
+  for(std::thread& thread : threads) thread.join();
+}
+
+int main() {
+  check_against_run();
+  check_slots();
+  check_errors();
+  check_threads();
+
+  return finish();
+}
@@ -0,0 +1,39 @@
+# runs one test script and compares what it prints with its .out file.
+# cmake -DBASICPL=<binary> -DSCRIPT=<name>.bpl [-DFLAGS=<flags>] -P run_test.cmake
+#
+# <name>.args holds extra options, <name>.csv makes the script run once
+# per record of it. the exit status is appended to the output, so a
+# script meant to fail must fail
+get_filename_component(dir ${SCRIPT} DIRECTORY)
+get_filename_component(name ${SCRIPT} NAME_WE)
+
+separate_arguments(args UNIX_COMMAND "${FLAGS}")
+
+if(EXISTS ${dir}/${name}.args)
+  file(READ ${dir}/${name}.args extra)
+  separate_arguments(extra UNIX_COMMAND "${extra}")
+  list(APPEND args ${extra})
+endif()
+
+if(EXISTS ${dir}/${name}.csv)
+  list(APPEND args --csv ${name}.csv --expr ${name}.bpl)
+else()
+  list(APPEND args ${name}.bpl)
+endif()
+
+# run from the script's directory, errors name files as they were given
+execute_process(
+  COMMAND ${BASICPL} ${args}
+  WORKING_DIRECTORY ${dir}
+  OUTPUT_VARIABLE output
+  ERROR_VARIABLE output
+  RESULT_VARIABLE status
+)
+
+string(APPEND output "exit ${status}\n")
+file(READ ${dir}/${name}.out expected)
+
+if(NOT output STREQUAL expected)
+  string(JOIN " " command ${args})
+  message(FATAL_ERROR "basicpl ${command} printed\n${output}\nexpected\n${expected}")
+endif()
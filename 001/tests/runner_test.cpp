@@ -0,0 +1,112 @@
+#include <string>
+#include <thread>
+#include <vector>
+#include "check.h"
+#include "../src/engine.h"
+#include "../src/runner.h"
+
+// BatchRunner against one engine running the same jobs in turn, reset
+// between them. batches are skewed so that whole queues run dry while
+// others still hold slow jobs, and workers have to steal
+
+static const char* SCRIPTS[] = {
+  "var total = 0; for i = 1 to n do var total = total + i * rate; total",
+  "if n > 50 then n * rate - 20 elif n > 10 then n * rate else 0",
+  "var a = 1; var b = 1; for i = 1 to n / 4 do var b = a + (var a = b); b",
+  "n / (n - n)",
+  "undefined_here + n",
+  "1 +",
+};
+
+static RunType run_alone(const Job& job) {
+  Engine engine;
+  for(const auto& [name, value] : job.bindings) engine.get_globals().set(name, value);
+  return engine.run(job.name, job.source);
+}
+
+static void check_batch(BatchRunner& runner, const std::vector<Job>& jobs, const std::string& what) {
+  std::vector<RunType> results = runner.run(jobs);
+  check(results.size() == jobs.size(), what + ": one result per job");
+
+  for(std::size_t i = 0; i < jobs.size() && i < results.size(); i++) {
+    RunType expected = run_alone(jobs[i]);
+    if(!same_result(results[i], expected)) {
+      check(false, what + " job " + std::to_string(i) + ": " + describe(results[i]) + ", alone " + describe(expected));
+      return;
+    }
+  }
+}
+
+static std::vector<Job> mixed_jobs(std::size_t count) {
+  std::vector<Job> jobs;
+
+  for(std::size_t i = 0; i < count; i++) {
+    jobs.push_back({ std::string("<job ") + std::to_string(i) + ">", SCRIPTS[i % 6], { { "n", (double)(i % 100) }, { "rate", 1.5 } } });
+  }
+
+  return jobs;
+}
+
+// the slow jobs all come first, so they land in the first queue
+static std::vector<Job> skewed_jobs(std::size_t count) {
+  std::vector<Job> jobs;
+
+  for(std::size_t i = 0; i < count; i++) {
+    double n = i < count / 4 ? 20000 : 1;
+    jobs.push_back({ "<skewed>", SCRIPTS[0], { { "n", n }, { "rate", 0.5 } } });
+  }
+
+  return jobs;
+}
+
+int main() {
+  for(unsigned threads : { 1u, 2u, 3u, 8u }) {
+    BatchRunner runner(threads);
+    std::string name = std::to_string(threads) + " threads";
+
+    check(runner.get_thread_count() == threads, name + ": thread count");
+    check(runner.run({}).empty(), name + ": empty batch");
+
+    // more workers than jobs leaves queues empty from the start
+    check_batch(runner, mixed_jobs(2), name + ", 2 jobs");
+    check_batch(runner, mixed_jobs(600), name + ", mixed");
+    check_batch(runner, skewed_jobs(200), name + ", skewed");
+    // the workers are reused from batch to batch
+    check_batch(runner, mixed_jobs(601), name + ", again");
+  }
+
+  BatchRunner runner(4);
+
+  // no job sees the variables another one defined
+  std::vector<Job> isolated;
+  for(int i = 0; i < 100; i++) {
+    isolated.push_back({ "<isolated>", std::string("var mine_") + std::to_string(i) + " = 1" });
+    isolated.push_back({ "<isolated>", std::string("mine_") + std::to_string(i) });
+  }
+
+  std::vector<RunType> results = runner.run(isolated);
+  for(std::size_t i = 1; i < results.size(); i += 2) {
+    check(headline(results[i].second).find("is not defined") != std::string::npos, std::string("job ") + std::to_string(i) + " sees another job's variable");
+  }
+
+  // a builtin cannot be bound, the job fails without running
+  std::vector<Job> builtins = {
+    { "<builtin>", "true", { { "true", 0 } } },
+    { "<builtin>", "n", { { "n", 3 }, { "null", 1 } } },
+    { "<builtin>", "n", { { "n", 3 } } },
+  };
+
+  results = runner.run(builtins);
+  check(headline(results[0].second) == "Runtime Error: cannot reassign built-in variable 'true'", std::string("bound true: ") + describe(results[0]));
+  check(headline(results[1].second) == "Runtime Error: cannot reassign built-in variable 'null'", std::string("bound null: ") + describe(results[1]));
+  check(same(number_of(results[2]), 3), std::string("job after a refused one: ") + describe(results[2]));
+
+  // calls from several threads take turns on the same runner
+  std::vector<std::thread> callers;
+  for(int t = 0; t < 3; t++) {
+    callers.emplace_back([&, t]() { check_batch(runner, mixed_jobs(300 + t), std::string("caller ") + std::to_string(t)); });
+  }
+  for(std::thread& caller : callers) caller.join();
+
+  return finish();
+}